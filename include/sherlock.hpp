@@ -7,11 +7,39 @@ static const char* VERSION = "1.0.0";
 
 }
 
+#include "sherlock/Batch.hpp"
 #include "sherlock/Captor.hpp"
+#include "sherlock/Cascade.hpp"
 #include "sherlock/Classifier.hpp"
+#include "sherlock/Clock.hpp"
+#include "sherlock/Control.hpp"
 #include "sherlock/Deallocator.hpp"
+#include "sherlock/Decoder.hpp"
+#include "sherlock/DetectionLog.hpp"
+#include "sherlock/Detections.hpp"
 #include "sherlock/Detector.hpp"
 #include "sherlock/Displayer.hpp"
+#include "sherlock/Edge.hpp"
+#include "sherlock/EventStream.hpp"
+#include "sherlock/Evaluator.hpp"
+#include "sherlock/ExclusionMask.hpp"
+#include "sherlock/FrameSource.hpp"
+#include "sherlock/Fuser.hpp"
+#include "sherlock/Graph.hpp"
+#include "sherlock/MatPool.hpp"
+#include "sherlock/Multiplexer.hpp"
+#include "sherlock/Overlay.hpp"
+#include "sherlock/Pacer.hpp"
+#include "sherlock/PerfCounters.hpp"
+#include "sherlock/Pipeline.hpp"
+#include "sherlock/Placement.hpp"
+#include "sherlock/Pyramid.hpp"
+#include "sherlock/Recording.hpp"
+#include "sherlock/Stages.hpp"
+#include "sherlock/TileCache.hpp"
+#include "sherlock/Trace.hpp"
+#include "sherlock/config.hpp"
 #include "sherlock/util.hpp"
+#include "sherlock/Watcher.hpp"
 
 #endif  // SHERLOCK_HPP_INCLUDED
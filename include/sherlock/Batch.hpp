@@ -0,0 +1,104 @@
+#ifndef SHERLOCK_BATCH_HPP_INCLUDED
+#define SHERLOCK_BATCH_HPP_INCLUDED
+
+// Include standard headers.
+#include <list>
+#include <memory>
+#include <mutex>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+#include <bites.hpp>
+
+// Include application headers.
+#include "Classifier.hpp"
+#include "Edge.hpp"
+#include "Evaluator.hpp"
+#include "Placement.hpp"
+#include "Pyramid.hpp"
+
+namespace sherlock {
+
+/**
+  Batched classifier thread, hosting any number of classifiers.
+
+  Classifiers using the native engine with the same scale factor are
+  evaluated together, in a single sweep over the frame's pyramid
+  (see Evaluator::detectBatch); any others are run one after another.
+  The hosted classifiers' own threads are not started.
+*/
+class Batch : public bites::Thread
+{
+public:
+
+    /**
+      Initialize the batch with I/O queues.
+      Detections are published through the hosted classifiers.
+      @param  input_queue     Input queue of incoming frames.
+      @param  done_queue      Output queue of processed (or skipped) frames.
+      @param  pyramids        Frame pyramids shared with other classifiers.
+    */
+    Batch(
+        Edge <cv::Mat*>& input_queue,
+        bites::ConcurrentQueue <cv::Mat*>& done_queue,
+        PyramidCache& pyramids
+        ):
+        m_input_queue(input_queue),
+        m_done_queue(done_queue),
+        m_pyramids(pyramids)
+        {/* Empty. */}
+
+    /**
+      Host given classifier, starting with the next frame processed
+      (and once the classifier is loaded.)
+    */
+    void addMember(Classifier* classifier);
+
+    /**
+      Stop hosting given classifier, waiting for the
+      frame being processed (if any) to finish.
+    */
+    void removeMember(Classifier* classifier);
+
+    /**
+      Return the input queue of incoming frames.
+    */
+    Edge <cv::Mat*>& getInputQueue() { return m_input_queue; }
+
+    /**
+       Set the placement applied by the thread as it starts.
+    */
+    void setPlacement(const Placement& placement) { m_placement = placement; }
+
+private:
+    /**
+      A hosted classifier, and its evaluator used in batches.
+    */
+    struct Member
+    {
+        Member(Classifier* classifier) :
+            classifier (classifier),
+            evaluator (new Evaluator(classifier->getCascade()))
+            {/* Empty. */}
+        Classifier* classifier;
+        std::unique_ptr <Evaluator> evaluator;
+    };
+
+    /**
+      Detect objects of all hosted classifiers in given frame,
+      at given resolution scale.
+    */
+    void detect(const cv::Mat* frame, const float& scale);
+
+    Edge <cv::Mat*>& m_input_queue;
+    bites::ConcurrentQueue <cv::Mat*>& m_done_queue;
+    PyramidCache& m_pyramids;
+    std::mutex m_mutex;
+    std::list <Member> m_members;
+    Placement m_placement;
+    void run();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_BATCH_HPP_INCLUDED
@@ -2,15 +2,26 @@
 #define SHERLOCK_CAPTOR_HPP_INCLUDED
 
 // Include standard headers.
+#include <atomic>
+#include <functional>
+#include <string>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <limits>
+#include <memory>
 
 // Include 3rd party headers.
 #include <opencv2/opencv.hpp>
 #include <bites.hpp>
 
+// Include application headers.
+#include "Clock.hpp"
+#include "Decoder.hpp"
+#include "Edge.hpp"
+#include "Pacer.hpp"
+#include "Placement.hpp"
+
 namespace sherlock {
 
 /**
@@ -25,7 +36,8 @@ public:
        @param  device     Device index.
        @param  width      Width of video.
        @param  height     Height of video.
-       @param  duration   Duration of detection (in seconds.)
+       @param  duration   Duration of detection (in seconds;
+                          until stopped, if not positive.)
        @param  max_fps    Maximum FPS rate limit.
     */
     Captor(
@@ -39,29 +51,132 @@ public:
         m_width         (width),
         m_height        (height),
         m_duration      (duration),
-        m_max_fps       (max_fps)
+        m_max_fps       (max_fps),
+        m_pacer         (max_fps),
+        m_stopping      (false),
+        m_realtime      (true)
         {/* Empty. */}
 
+    /**
+       Request the capture to stop: the thread stops capturing,
+       discards frames still queued on the outputs, and pushes
+       the end of processing.  Only sets a flag, hence may be
+       called from a signal handler.
+    */
+    void stop() { m_stopping = true; }
+
+    /**
+       Return true if the capture was requested to stop.
+    */
+    bool isStopping() const { return m_stopping; }
+
     /**
        Add an output queue for allocated frames.
     */
-    void addOutput( bites::ConcurrentQueue <cv::Mat*>& );
+    void addOutput( Edge <cv::Mat*>& );
+
+    /**
+       Remove an output queue.
+       No frames are pushed onto the queue after this returns.
+    */
+    void removeOutput( Edge <cv::Mat*>& );
+
+    /**
+       Set the callback invoked with every captured frame,
+       and the number of output queues it is about to be pushed onto.
+    */
+    void setFanoutCallback( std::function <void (cv::Mat*, int)> callback );
 
     /**
        Retrieve the current capture framerate.
     */
     std::vector <float> getFramerate ();
 
+    /**
+       Change the maximum FPS rate limit (while running.)
+    */
+    void setMaxFps( const float& max_fps ) { m_pacer.setMaxFps(max_fps); }
+
+    /**
+       Retrieve the pacing jitter statistics.
+    */
+    Pacer::Stats getPacingStats () { return m_pacer.getStats(); }
+
+    /**
+       Record captured frames (and capture times) into given file.
+       Must be called before the thread is started.
+    */
+    void setRecording( const std::string& fname ) { m_record_fname = fname; }
+
+    /**
+       Replay frames recorded in given file (or a video file), instead
+       of capturing.  Recorded frames are replayed in lockstep: a frame
+       is pushed only once the previous one has been released (see
+       frameDone), so that every frame is processed by all outputs, for
+       identical results on every replay.  Frames are decoded ahead
+       while the previous ones are processed (see Decoder.)  The
+       duration (if positive) limits the recorded time replayed.
+       Must be called before the thread is started.
+
+       @param  fname     Name of recording file.
+       @param  realtime  If true, frames are not pushed ahead of their
+                         recorded times; otherwise, as fast as possible.
+       @param  decoders  Number of threads decoding a recording.
+    */
+    void setReplay( const std::string& fname, const bool& realtime, const int& decoders = 2 );
+
+    /**
+       Return true if replaying a recording.
+    */
+    bool isReplaying () const { return !m_replay_fname.empty(); }
+
+    /**
+       Retrieve the decoding statistics of the replay.
+    */
+    Decoder::Stats getDecodeStats ();
+
+    /**
+       Return the clock of the capture: the replay clock (at the
+       recorded time of the frame last pushed) when replaying,
+       and the system clock otherwise.
+    */
+    Clock& getClock ();
+
+    /**
+       Set the placement applied by the thread as it starts
+       (frames are allocated by the thread, hence on the
+       placement's NUMA node, if any.)
+    */
+    void setPlacement( const Placement& placement ) { m_placement = placement; }
+
+    /**
+       Notify the captor that a frame has been released
+       (required for each frame when replaying.)
+    */
+    void frameDone( cv::Mat* frame );
+
 private:
     int m_device;
     int m_width;
     int m_height;
     int m_duration;
     float m_max_fps;
+    Pacer m_pacer;
+    Placement m_placement;
+    std::atomic <bool> m_stopping;
+
+    // Recording and replay.
+    std::string m_record_fname;
+    std::string m_replay_fname;
+    bool m_realtime;
+    ReplayClock m_replay_clock;
+    std::unique_ptr <Decoder> m_decoder;
+    bites::ConcurrentQueue <cv::Mat*> m_released;
 
     // The output queues and the associated access mutex.
     std::mutex m_output_queues_mutex;
-    std::vector< bites::ConcurrentQueue <cv::Mat*>* > m_output_queues;
+    std::vector< Edge <cv::Mat*>* > m_output_queues;
+    std::function <void (cv::Mat*, int)> m_fanout_callback;
 
     // The current running framerate.
     bites::Mutexed <std::vector <float>> m_framerate;
@@ -71,6 +186,17 @@ private:
     */
     void pushOutput( cv::Mat* frame );
 
+    /**
+       Push the end of processing onto all output queues (discarding
+       the frames queued, if stopping.)
+    */
+    void endOutput();
+
+    /**
+       Replay the recording (instead of capturing.)
+    */
+    void replay();
+
     /**
        The threaded function.
     */
@@ -0,0 +1,171 @@
+#ifndef SHERLOCK_CASCADE_HPP_INCLUDED
+#define SHERLOCK_CASCADE_HPP_INCLUDED
+
+// Include standard headers.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Compiled cascade classifier.
+
+   A cascade XML file (in either the current or the legacy OpenCV
+   format) is compiled into a single flat binary image holding stages,
+   trees, nodes, leaves and features as separate arrays.
+   Compiled images are cached on disk, keyed by a hash of the XML
+   content, and are memory-mapped on subsequent loads, so that
+   restarting with a warm cache involves no XML parsing at all.
+*/
+class Cascade
+{
+public:
+    /**
+       Type of features evaluated by the cascade.
+    */
+    enum FeatureType { HAAR = 0, LBP = 1 };
+
+    /**
+       Create an empty cascade.
+    */
+    Cascade();
+    ~Cascade();
+
+    /**
+       Load the cascade from given XML file, using the compiled
+       image in *cache_dir* if one exists for the file's content,
+       and compiling (and caching) it otherwise.
+
+       @param  fname      Name of XML file.
+       @param  cache_dir  Directory holding compiled images.
+       @return  True on success.
+    */
+    bool load(const std::string& fname, const std::string& cache_dir);
+
+    /**
+       Compile the cascade from given XML file, bypassing the cache.
+
+       @param  fname  Name of XML file.
+       @return  True on success.
+    */
+    bool compile(const std::string& fname);
+
+    /**
+       Return the default cache directory, derived from
+       the XDG_CACHE_HOME or HOME environment variables.
+    */
+    static std::string defaultCacheDir();
+
+    /**
+       Return true if no cascade is loaded.
+    */
+    bool empty() const { return m_header == NULL; }
+
+    /**
+       Return true if the cascade was loaded from the cache.
+    */
+    bool cached() const { return m_map != NULL; }
+
+    // Cascade properties.
+    FeatureType featureType() const;
+    cv::Size windowSize() const;
+    uint64_t sourceHash() const;
+    int stageCount() const;
+    int treeCount() const;
+    int nodeCount() const;
+    int leafCount() const;
+    int featureCount() const;
+    int subsetSize() const;
+    bool hasTilted() const;
+    bool isStump() const;
+
+    // Stage arrays, indexed by stage.
+    const int32_t* stageFirstTree() const { return m_stage_first_tree; }
+    const int32_t* stageTreeCount() const { return m_stage_tree_count; }
+    const float* stageThreshold() const { return m_stage_threshold; }
+
+    // Tree arrays, indexed by tree.
+    const int32_t* treeFirstNode() const { return m_tree_first_node; }
+    const int32_t* treeFirstLeaf() const { return m_tree_first_leaf; }
+
+    // Node arrays, indexed by node.  A child index <= 0 denotes
+    // leaf number -index of the enclosing tree.
+    const int32_t* nodeFeature() const { return m_node_feature; }
+    const float* nodeThreshold() const { return m_node_threshold; }
+    const int32_t* nodeLeft() const { return m_node_left; }
+    const int32_t* nodeRight() const { return m_node_right; }
+    const int32_t* nodeSubset() const { return m_node_subset; }
+
+    // Leaf array.
+    const float* leafValue() const { return m_leaf_value; }
+
+    // Feature arrays, indexed by feature.  Each feature has three
+    // rectangle slots of (x, y, width, height) and a weight per slot.
+    // LBP features use slot 0 only, with zero weights.
+    const int32_t* featureRects() const { return m_feature_rects; }
+    const float* featureWeights() const { return m_feature_weights; }
+    const int32_t* featureTilted() const { return m_feature_tilted; }
+
+private:
+    // Disallow copying.
+    Cascade(const Cascade&);
+    Cascade& operator=(const Cascade&);
+
+    struct Header;
+
+    /**
+       Release the loaded image (if any.)
+    */
+    void clear();
+
+    /**
+       Validate the image of given size at given address,
+       and point the array accessors into it.
+    */
+    bool attach(const char* data, const size_t& size);
+
+    /**
+       Compile XML file into the in-memory buffer.
+    */
+    bool compileFile(const std::string& fname, const uint64_t& hash);
+
+    /**
+       Memory-map the given cache file, verifying it
+       was compiled from XML of given hash.
+    */
+    bool mapFile(const std::string& fname, const uint64_t& hash);
+
+    /**
+       Write the in-memory image to given cache file.
+    */
+    bool writeFile(const std::string& fname) const;
+
+    // Owned image (when compiled) or mapped image (when cached.)
+    std::vector <uint64_t> m_buffer;
+    void* m_map;
+    size_t m_map_size;
+
+    const Header* m_header;
+    const int32_t* m_stage_first_tree;
+    const int32_t* m_stage_tree_count;
+    const float* m_stage_threshold;
+    const int32_t* m_tree_first_node;
+    const int32_t* m_tree_first_leaf;
+    const int32_t* m_node_feature;
+    const float* m_node_threshold;
+    const int32_t* m_node_left;
+    const int32_t* m_node_right;
+    const int32_t* m_node_subset;
+    const float* m_leaf_value;
+    const int32_t* m_feature_rects;
+    const float* m_feature_weights;
+    const int32_t* m_feature_tilted;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_CASCADE_HPP_INCLUDED
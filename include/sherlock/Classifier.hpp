@@ -2,12 +2,26 @@
 #define SHERLOCK_CLASSIFIER_HPP_INCLUDED
 
 // Include standard headers.
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 
 // Include 3rd party headers.
 #include <opencv2/opencv.hpp>
 #include <bites.hpp>
 
+// Include application headers.
+#include "Cascade.hpp"
+#include "Detections.hpp"
+#include "Edge.hpp"
+#include "Evaluator.hpp"
+#include "ExclusionMask.hpp"
+#include "Placement.hpp"
+#include "Pyramid.hpp"
+#include "Trace.hpp"
+
 namespace sherlock {
 
 /**
@@ -18,58 +32,203 @@ class Classifier : public bites::Thread
 public:
 
     /**
-      The resulting datum of the classifier,
-      a rectangle and associated color.
+      Detection parameters, adjustable while the classifier runs.
     */
-    struct RectColor{
-        cv::Rect rect;     /**< the rectangle object */
-        cv::Scalar color;  /**< the associated color */
+    struct Parameters{
+        cv::Scalar color;      /**< color associated with the classifier */
+        float scale_factor;    /**< amount to reduce image at each scale */
+        int min_neighbors;     /**< neighbors each candidate rectangle retains */
+        float min_size_ratio;  /**< ratio of image size for minimum object size */
+        float max_size_ratio;  /**< ratio of image size for maximum object size */
+        bool native;           /**< use the native cascade evaluator */
+        float resolution;      /**< scale of frames detected in (AUTO_RESOLUTION:
+                                    such that the smallest objects just fit
+                                    the cascade window) */
+        TileCache::Parameters tiles;  /**< tiling of the cache of results
+                                           (native evaluator only) */
+        std::shared_ptr <const ExclusionMask> exclusion;  /**< areas of the source
+                                                               not scanned (if any) */
     };
 
     /**
-      Initialize the classifer with filename, color and I/O queues.
+      Detection resolution fitting the smallest objects to the cascade window.
+    */
+    static constexpr float AUTO_RESOLUTION = 0;
+
+    /**
+      Initialize the classifer with filename, parameters and I/O queues.
+      The cascade itself is not loaded until load() is called.
       @param  fname           Name of XML file.
-      @param  color           Color associated with the classifier.
-      @param  scale_factor    Amount to reduce image at each scale.
-      @param  min_neighbors   Number of neighbors each candidate rectangle retains.
-      @param  min_size_ratio  Ratio of image size for minimum possible object size.
-      @param  max_size_ratio  Ratio of image size for maximum possible object size.
+      @param  cache_dir       Directory of compiled cascade cache.
+      @param  params          Detection parameters.
+      @param  index           Index of the classifier (in the Palette.)
       @param  input_queue     Input queue of incoming frames.
-      @param  output_queue    Output queue of resulting RectColor objects.
+      @param  output_queue    Output queue of resulting Detections batches.
+      @param  pool            Pool of Detections batches.
       @param  done_queue      Output queue of processed (or skipped) frames.
+      @param  pyramids        Frame pyramids shared with other classifiers.
     */
     Classifier(
         const std::string& fname,
-        const cv::Scalar& color,
-        const float& scale_factor,
-        const int& min_neighbors,
-        const float& min_size_ratio,
-        const float& max_size_ratio,
-        bites::ConcurrentQueue <cv::Mat*>& input_queue,
-        bites::ConcurrentQueue <Classifier::RectColor>& output_queue,
-        bites::ConcurrentQueue <cv::Mat*>& done_queue
+        const std::string& cache_dir,
+        const Parameters& params,
+        const int& index,
+        Edge <cv::Mat*>& input_queue,
+        bites::ConcurrentQueue <Detections*>& output_queue,
+        DetectionsPool& pool,
+        bites::ConcurrentQueue <cv::Mat*>& done_queue,
+        PyramidCache& pyramids
         ):
-        m_color(color),
-        m_scale_factor(scale_factor),
-        m_min_neighbors(min_neighbors),
-        m_min_size_ratio(min_size_ratio),
-        m_max_size_ratio(max_size_ratio),
+        m_fname(fname),
+        m_cache_dir(cache_dir),
+        m_index(index),
         m_input_queue(input_queue),
         m_output_queue(output_queue),
-        m_cv_classifier(fname),
-        m_done_queue(done_queue)
-        {/* Empty. */}
+        m_pool(pool),
+        m_done_queue(done_queue),
+        m_pyramids(pyramids),
+        m_evaluator(m_cascade),
+        m_ready(false),
+        m_paused(false),
+        m_trace_name(Trace::intern("detect " + fname))
+        {
+            setParameters(params);
+        }
+
+    /**
+      Load the cascade.  May be called from any thread, before or
+      after the classifier thread is started; until then, incoming
+      frames are passed straight through to the done queue.
+      @return  True if the cascade was loaded.
+    */
+    bool load();
+
+    /**
+      Replace the detection parameters, taking effect
+      with the next frame processed.
+    */
+    void setParameters(const Parameters& params) { m_params.set(params); }
+
+    /**
+      Retrieve the current detection parameters.
+    */
+    Parameters getParameters() { return m_params.get(); }
+
+    /**
+      Return the input queue of incoming frames.
+    */
+    Edge <cv::Mat*>& getInputQueue() { return m_input_queue; }
+
+    /**
+      Return the XML file name.
+    */
+    const std::string& getFilename() const { return m_fname; }
+
+    /**
+      Return the index of the classifier.
+    */
+    int getIndex() const { return m_index; }
+
+    /**
+      Return true once the cascade has been loaded.
+    */
+    bool isReady() const { return m_ready; }
+
+    /**
+      Pause (or resume) detection; frames are passed
+      straight through while paused.
+    */
+    void setPaused(const bool& paused) { m_paused = paused; }
+    bool isPaused() const { return m_paused; }
+
+    /**
+      Retrieve the statistics of the tile cache (of frames detected
+      by the classifier thread itself.)
+    */
+    TileCache::Stats getTileStats() const { return m_evaluator.getTileStats(); }
+
+    /**
+      Return the compiled cascade (empty if it could not be compiled,
+      or if the native evaluator was not selected as it was loaded.)
+    */
+    const Cascade& getCascade() const { return m_cascade; }
+
+    /**
+      Return true if the native evaluator is to be used
+      (it is selected, and the cascade was compiled.)
+    */
+    bool useNative(const Parameters& params) const
+    {
+        return params.native && !m_cascade.empty();
+    }
+
+    /**
+      Return the resolution scale (at most 1) at which to detect
+      in frames of given size, with given parameters.
+    */
+    float getResolution(const Parameters& params, const cv::Size& size) const;
+
+    /**
+      Detect objects in given frame with given parameters, on the
+      calling thread (used by the classifier thread, or by a Batch
+      hosting the classifier.)  The classifier must be ready.
+      @param  frame   The frame.
+      @param  params  Detection parameters.
+      @param  rects   Output detected objects (in frame coordinates.)
+      @param  scale   Resolution scale at which to process the frame
+                      (besides the detection resolution.)
+    */
+    void detect(
+        const cv::Mat* frame,
+        const Parameters& params,
+        std::vector <cv::Rect>& rects,
+        const float& scale = 1);
+
+    /**
+      Push the detections in given frame onto the output queue,
+      as a single batch (and pass them on to the result callback, if any.)
+    */
+    void publish(
+        const cv::Mat* frame,
+        const std::vector <cv::Rect>& rects);
+
+    /**
+      Set the callback invoked with the detections of every
+      processed frame (with the XML file name.)
+      Must be set before frames are processed.
+    */
+    void setResultCallback(
+        std::function <void (const cv::Mat*, const std::string&,
+                             const std::vector <cv::Rect>&)> callback)
+    {
+        m_result_callback = callback;
+    }
+
+    /**
+       Set the placement applied by the thread as it starts.
+    */
+    void setPlacement(const Placement& placement) { m_placement = placement; }
 
 private:
-    const cv::Scalar m_color;
-    const float m_scale_factor;
-    const int m_min_neighbors;
-    const float m_min_size_ratio;
-    const float m_max_size_ratio;
-    bites::ConcurrentQueue <cv::Mat*>& m_input_queue;
-    bites::ConcurrentQueue <Classifier::RectColor>& m_output_queue;
+    const std::string m_fname;
+    const std::string m_cache_dir;
+    const int m_index;
+    bites::Mutexed <Parameters> m_params;
+    Edge <cv::Mat*>& m_input_queue;
+    bites::ConcurrentQueue <Detections*>& m_output_queue;
+    DetectionsPool& m_pool;
     bites::ConcurrentQueue <cv::Mat*>& m_done_queue;
+    PyramidCache& m_pyramids;
+    Cascade m_cascade;
+    Evaluator m_evaluator;
     cv::CascadeClassifier m_cv_classifier;
+    std::mutex m_cv_mutex;  // OpenCV classifier (shared by batch threads.)
+    std::atomic <bool> m_ready;
+    std::atomic <bool> m_paused;
+    std::function <void (const cv::Mat*, const std::string&,
+                         const std::vector <cv::Rect>&)> m_result_callback;
+    Placement m_placement;
+    const char* m_trace_name;
     void run();
 };
 
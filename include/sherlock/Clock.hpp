@@ -0,0 +1,64 @@
+#ifndef SHERLOCK_CLOCK_HPP_INCLUDED
+#define SHERLOCK_CLOCK_HPP_INCLUDED
+
+// Include standard headers.
+#include <mutex>
+
+// Include 3rd party headers.
+#include <boost/date_time.hpp>
+
+namespace sherlock {
+
+/**
+   Source of time for pacing and time-based effects,
+   the system clock unless replaced (e.g. by a ReplayClock.)
+*/
+class Clock
+{
+public:
+    virtual ~Clock() {/* Empty. */}
+
+    /**
+       Return the current time.
+    */
+    virtual boost::posix_time::ptime now();
+
+    /**
+       Sleep for given duration (if positive.)
+    */
+    virtual void sleep(const boost::posix_time::time_duration& duration);
+
+    /**
+       Return the (shared) system clock.
+    */
+    static Clock& system();
+};
+
+/**
+   Clock of a replayed recording: the current time is the
+   capture time of the frame being replayed, set by the replayer.
+   Sleeping merely advances the time.
+*/
+class ReplayClock : public Clock
+{
+public:
+    ReplayClock() :
+        m_now (boost::posix_time::not_a_date_time)
+        {/* Empty. */}
+
+    /**
+       Set the current time.
+    */
+    void set(const boost::posix_time::ptime& now);
+
+    boost::posix_time::ptime now();
+    void sleep(const boost::posix_time::time_duration& duration);
+
+private:
+    std::mutex m_mutex;
+    boost::posix_time::ptime m_now;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_CLOCK_HPP_INCLUDED
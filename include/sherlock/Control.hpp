@@ -0,0 +1,75 @@
+#ifndef SHERLOCK_CONTROL_HPP_INCLUDED
+#define SHERLOCK_CONTROL_HPP_INCLUDED
+
+// Include standard headers.
+#include <functional>
+#include <string>
+
+// Include 3rd party headers.
+#include <bites.hpp>
+
+namespace sherlock {
+
+/**
+   Control socket thread, serving commands of local clients
+   on a Unix-domain stream socket.
+
+   Clients send one command per line, and receive a reply per
+   command, either
+      OK LENGTH\n  followed by LENGTH bytes of payload, or
+      ERROR MESSAGE\n
+   Commands are handled by a callback, on the control thread.
+   Replies are sent without blocking; clients not reading them,
+   and falling behind by too much, are disconnected.
+*/
+class Control : public bites::Thread
+{
+public:
+    /**
+       Command handler: fills in the reply payload (or error message.)
+       @return  False if the command failed.
+    */
+    typedef std::function <bool (const std::string& command, std::string& reply)> Handler;
+
+    /**
+       Initialize the control.
+
+       @param  handler     Command handler.
+       @param  on_clients  Callback invoked (on the control thread)
+                           with the number of clients, whenever
+                           a client connects or disconnects.
+    */
+    Control(Handler handler, std::function <void (int)> on_clients);
+    ~Control();
+
+    /**
+       Create the socket at given path (replacing any stale socket.)
+       @return  False if the socket could not be created.
+    */
+    bool open(const std::string& path);
+
+    /**
+       Return true if the socket was created.
+    */
+    bool isOpen() const { return m_listen_fd >= 0; }
+
+    /**
+       Signal the control thread to stop (disconnecting all clients.)
+    */
+    void stop();
+
+private:
+    Handler m_handler;
+    std::function <void (int)> m_on_clients;
+    std::string m_path;
+    int m_listen_fd;
+
+    // Event descriptor used to wake up the thread for stopping.
+    int m_stop_fd;
+
+    void run();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_CONTROL_HPP_INCLUDED
@@ -1,10 +1,18 @@
 #ifndef SHERLOCK_DEALLOCATOR_HPP_INCLUDED
 #define SHERLOCK_DEALLOCATOR_HPP_INCLUDED
 
+// Include standard headers.
+#include <functional>
+#include <map>
+#include <mutex>
+
 // Include 3rd party headers.
 #include <opencv2/opencv.hpp>
 #include <bites.hpp>
 
+// Include application headers.
+#include "Placement.hpp"
+
 namespace sherlock {
 
 /*!
@@ -16,9 +24,37 @@ public:
     Deallocator( bites::ConcurrentQueue <cv::Mat*>& done_queue ) 
         : m_done_queue(done_queue) {/* Empty. */}
     void setTrigger(const int& value) { m_trigger = value; }
+
+    /**
+       Set the deallocation trigger of an individual frame,
+       overriding the common trigger.  Must be called before
+       the frame enters the done queue.
+    */
+    void expect(cv::Mat* frame, const int& count);
+
+    /**
+       Set the callback invoked with every frame right before
+       it is deallocated.
+    */
+    void setReleaseCallback(std::function <void (cv::Mat*)> callback)
+    {
+        m_release_callback = callback;
+    }
+
+    /**
+       Set the placement applied by the thread as it starts.
+    */
+    void setPlacement(const Placement& placement) { m_placement = placement; }
+
 private:
     bites::ConcurrentQueue <cv::Mat*>& m_done_queue;
     int m_trigger = -1;
+    std::function <void (cv::Mat*)> m_release_callback;
+
+    // Per-frame triggers, and the associated access mutex.
+    std::mutex m_expected_mutex;
+    std::map <cv::Mat*, int> m_expected;
+    Placement m_placement;
     void run();
 };
 
@@ -0,0 +1,121 @@
+#ifndef SHERLOCK_DECODER_HPP_INCLUDED
+#define SHERLOCK_DECODER_HPP_INCLUDED
+
+// Include standard headers.
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Include 3rd party headers.
+#include <boost/date_time.hpp>
+#include <opencv2/opencv.hpp>
+
+// Include application headers.
+#include "Recording.hpp"
+
+namespace sherlock {
+
+/**
+   Read-ahead decoder of a file source: decodes frames on threads of
+   its own, up to a number of frames ahead of their use, into frames
+   allocated from the matrix pool.  Frames of a recording or of a
+   Motion JPEG video are encoded independently, and decoded by all
+   threads; other video files are decoded by one (as their frames
+   depend on the ones before.)  Frames are returned in order.
+*/
+class Decoder
+{
+public:
+    /**
+       Decoding statistics.
+    */
+    struct Stats
+    {
+        long frames;         /**< number of frames decoded */
+        double decode_msec;  /**< time spent decoding (summed over threads) */
+        double wait_msec;    /**< time spent waiting for frames not yet decoded */
+    };
+
+    /**
+       Initialize the decoder.
+
+       @param  threads  Number of decoding threads (of a recording
+                        or a Motion JPEG video.)
+       @param  depth    Number of frames decoded ahead at most.
+    */
+    Decoder(const int& threads = 2, const int& depth = 4);
+
+    /**
+       Stop decoding, and discard frames decoded ahead.
+    */
+    ~Decoder();
+
+    /**
+       Open a recording (see RecordingWriter) or, failing that, a video
+       file (frames timed from the start of the video), and start
+       decoding ahead.
+       @return  False if the file could not be opened.
+    */
+    bool open(const std::string& fname);
+
+    /**
+       Take the next frame (waiting for it to be decoded), and its
+       capture time.  The frame is owned by the caller.
+       @return  False at the end of the file.
+    */
+    bool read(cv::Mat*& frame, boost::posix_time::ptime& tstamp);
+
+    /**
+       Retrieve the decoding statistics.
+    */
+    Stats getStats();
+
+    /**
+       Print the decoding statistics.
+    */
+    void report(std::ostream& out);
+
+private:
+    const int m_threads;
+    const int m_depth;
+    RecordingReader m_recording;
+    MjpegReader m_mjpeg;
+    cv::VideoCapture m_video;
+    bool m_is_video;
+    bool m_is_mjpeg;
+    std::vector <std::thread> m_workers;
+
+    // A decoded frame, and its capture time.
+    struct Decoded
+    {
+        cv::Mat* frame;
+        boost::posix_time::ptime tstamp;
+    };
+
+    // The frames decoded (by sequence number), the number of frames
+    // read from the file and taken by read(), whether the end of the
+    // file was reached or decoding stopped, statistics, and the mutex
+    // and conditions guarding them.
+    std::mutex m_mutex;
+    std::condition_variable m_room;
+    std::condition_variable m_decoded;
+    std::map <long, Decoded> m_frames;
+    long m_read;
+    long m_taken;
+    bool m_ended;
+    bool m_stopping;
+    Stats m_stats;
+
+    /**
+       The function of decoding threads.
+    */
+    void decode();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_DECODER_HPP_INCLUDED
@@ -0,0 +1,75 @@
+#ifndef SHERLOCK_DETECTIONLOG_HPP_INCLUDED
+#define SHERLOCK_DETECTIONLOG_HPP_INCLUDED
+
+// Include standard headers.
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Log of detections, frame by frame, for comparing runs.
+
+   Frames are numbered in capture order.  Once a frame has been
+   released, its detections are written out as lines of
+      FRAME CLASSIFIER X Y WIDTH HEIGHT
+   sorted by classifier and rectangle, so that runs of a replayed
+   recording (see Captor::setReplay) produce identical logs.
+*/
+class DetectionLog
+{
+public:
+    /**
+       Create the log file.
+       @return  False if the file could not be created.
+    */
+    bool open(const std::string& fname);
+
+    /**
+       Return true if the log file is open.
+    */
+    bool isOpen() const { return m_file.is_open(); }
+
+    /**
+       Number the newly captured frame.
+    */
+    void capture(const cv::Mat* frame);
+
+    /**
+       Add the detections of a classifier in given frame.
+    */
+    void add(
+        const cv::Mat* frame,
+        const std::string& classifier,
+        const std::vector <cv::Rect>& rects);
+
+    /**
+       Write out the detections of given frame (which is released.)
+    */
+    void release(const cv::Mat* frame);
+
+private:
+    /**
+       Detections of a frame in flight.
+    */
+    struct Entry
+    {
+        long number;
+        std::vector <std::pair <std::string, cv::Rect>> detections;
+    };
+
+    std::ofstream m_file;
+    std::mutex m_mutex;
+    long m_count = 0;
+    std::map <const cv::Mat*, Entry> m_entries;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_DETECTIONLOG_HPP_INCLUDED
@@ -0,0 +1,133 @@
+#ifndef SHERLOCK_DETECTIONS_HPP_INCLUDED
+#define SHERLOCK_DETECTIONS_HPP_INCLUDED
+
+// Include standard headers.
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Detections of one classifier in one frame, in structure-of-arrays
+   layout (rectangle coordinates are 16-bit, which covers any frame
+   up to 32767 pixels in either dimension.)  Batches are recycled
+   through a DetectionsPool, so their arrays are rarely reallocated.
+
+   Fused detections of all classifiers in a frame (see Fuser) also
+   carry the classifier and the confidence of each detection.
+*/
+struct Detections
+{
+    /**
+       Classifier index of fused batches.
+    */
+    static const int FUSED = -1;
+
+    /**
+       Classifier index of batches marking the frame as released.
+    */
+    static const int END_OF_FRAME = -2;
+
+    const cv::Mat* frame;            /**< the frame (an identity only,
+                                          valid while the frame is in flight) */
+    int classifier;                  /**< index of the classifier (see Palette) */
+    std::vector <int16_t> x;         /**< left edges */
+    std::vector <int16_t> y;         /**< top edges */
+    std::vector <int16_t> width;     /**< widths */
+    std::vector <int16_t> height;    /**< heights */
+    std::vector <int16_t> label;     /**< classifiers (fused batches only) */
+    std::vector <float> score;       /**< confidences (fused batches only) */
+
+    /**
+       Return the number of detections.
+    */
+    size_t size() const { return x.size(); }
+
+    /**
+       Remove all detections.
+    */
+    void clear();
+
+    /**
+       Append a detection.
+    */
+    void push_back(const cv::Rect& rect);
+
+    /**
+       Append a fused detection.
+    */
+    void push_back(const cv::Rect& rect, const int& classifier, const float& confidence);
+
+    /**
+       Return the classifier of the detection at given index.
+    */
+    int classifierOf(const size_t& index) const
+    {
+        return label.empty() ? classifier : label[index];
+    }
+
+    /**
+       Return the detection at given index.
+    */
+    cv::Rect rect(const size_t& index) const
+    {
+        return cv::Rect(x[index], y[index], width[index], height[index]);
+    }
+};
+
+/**
+   Pool of detections batches, shared by producers and consumers.
+*/
+class DetectionsPool
+{
+public:
+    ~DetectionsPool();
+
+    /**
+       Return an empty batch (recycled, if any are free.)
+    */
+    Detections* acquire();
+
+    /**
+       Return a batch to the pool.
+    */
+    void release(Detections* detections);
+
+private:
+    std::mutex m_mutex;
+    std::vector <Detections*> m_free;
+};
+
+/**
+   Colors of classifiers, by classifier index.
+*/
+class Palette
+{
+public:
+    /**
+       Add a color, returning the index of its classifier.
+    */
+    int add(const cv::Scalar& color);
+
+    /**
+       Replace the color of given classifier.
+    */
+    void set(const int& index, const cv::Scalar& color);
+
+    /**
+       Return the color of given classifier.
+    */
+    cv::Scalar get(const int& index);
+
+private:
+    std::mutex m_mutex;
+    std::vector <cv::Scalar> m_colors;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_DETECTIONS_HPP_INCLUDED
@@ -2,6 +2,10 @@
 #define SHERLOCK_DETECTOR_HPP_INCLUDED
 
 // Include standard headers.
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 // Include 3rd party headers.
@@ -9,10 +13,19 @@
 #include <bites.hpp>
 
 // Include application headers.
+#include "Batch.hpp"
 #include "Captor.hpp"
 #include "Classifier.hpp"
+#include "Control.hpp"
 #include "Deallocator.hpp"
+#include "DetectionLog.hpp"
 #include "Displayer.hpp"
+#include "EventStream.hpp"
+#include "Fuser.hpp"
+#include "PerfCounters.hpp"
+#include "Pyramid.hpp"
+#include "Watcher.hpp"
+#include "config.hpp"
 
 namespace sherlock {
 
@@ -29,7 +42,8 @@ public:
        @param  device        Device index.
        @param  width         Width of video.
        @param  height        Height of video.
-       @param  duration      Duration of detection (in seconds.)
+       @param  duration      Duration of detection (in seconds;
+                             until stopped, if not positive.)
        @param  max_fps       Maximum FPS capture limit.
        @param  config_fname  Classifier configuration file.
     */
@@ -42,12 +56,157 @@ public:
         const std::string& config_fname);
     ~Detector();
 
+    /**
+       Record the capture session into given file.
+       Must be called before run().
+    */
+    void setRecording(const std::string& fname) { m_captor.setRecording(fname); }
+
+    /**
+       Replay the recording in given file, instead of capturing
+       (see Captor::setReplay.)  All cascades are loaded before
+       replay starts.  Must be called before run().
+
+       @param  fname     Name of recording (or video) file.
+       @param  realtime  Replay in real time (rather than as fast as possible.)
+       @param  decoders  Number of threads decoding the recording.
+    */
+    void setReplay(const std::string& fname, const bool& realtime, const int& decoders = 2)
+    {
+        m_captor.setReplay(fname, realtime, decoders);
+    }
+
+    /**
+       Log detections of every frame into given file (see DetectionLog.)
+       Must be called before run().
+       @return  False if the file could not be created.
+    */
+    bool setDetectionLog(const std::string& fname);
+
+    /**
+       Publish detection events on a socket at given address
+       (see EventStream.)  Must be called before run().
+       @return  False if the socket could not be created.
+    */
+    bool setEventStream(const std::string& address, const EventStream::Format& format);
+
+    /**
+       Serve commands on a control socket at given path
+       (see Control, and command() for the commands.)
+       Must be called before run().
+       @return  False if the socket could not be created.
+    */
+    bool setControl(const std::string& path);
+
+    /**
+       Save the span trace into given file as detection ends
+       (see Trace; tracing must be compiled in.)
+    */
+    void setTrace(const std::string& fname) { m_trace_fname = fname; }
+
+    /**
+       Count hardware performance events of every stage, reported
+       per frame with statistics and as detection ends (see
+       PerfCounters.)  Must be called before run().
+    */
+    void setPerfCounters(const bool& enabled) { PerfCounters::setEnabled(enabled); }
+
+    /**
+       Show frames in a window (the default), or run without
+       (annotating frames only for snapshots.)
+       Must be called before run().
+    */
+    void setWindow(const bool& window) { m_displayer.setWindow(window); }
+
     /**
        Start detection.
     */
     void run();
 
+    /**
+       Request detection to stop.  Capture stops, frames queued to
+       any stage are discarded, and the frames being processed are
+       finished, so that the destructor returns once the stages have
+       passed on at most one frame each.  Only sets a flag, hence
+       may be called from a signal handler.
+    */
+    void stop() { m_captor.stop(); }
+
 private:
+    /**
+       Load cascades of queued classifiers (the loader thread function.)
+    */
+    void load();
+
+    /**
+       Start loader threads loading the cascades of given classifiers
+       (concurrently, one thread per CPU at most.)
+    */
+    void startLoaders(const std::vector <Classifier*>& classifiers);
+
+    /**
+       Wait for the loader threads to finish the cascades they are
+       loading, without loading the others queued.
+       @return  The classifiers left to load.
+    */
+    std::vector <Classifier*> stopLoaders();
+
+    /**
+       Create the workers of a classifier (as many as the classifiers
+       stage has threads) and their shared input queue, and register
+       the queue as video capture output (or, if batched, create a
+       single worker, and add it to every batch thread instead.)
+       @return  The workers.
+    */
+    std::vector <Classifier*> addClassifier(
+        const ClassifierEntry& entry,
+        const std::string& cache_dir);
+
+    /**
+       Unregister the input queue of the classifier of given file name,
+       wait for its workers to pass on frames already queued (or, if
+       batched, remove it from the batch threads), report the queue's
+       counters, and destroy the workers and the queue.
+    */
+    void retireClassifier(const std::string& fname);
+
+    /**
+       Apply changes of the configuration file to the running
+       pipeline (the watcher callback.)
+    */
+    void reload();
+
+    /**
+       Pass the detections of a classifier on to the detection
+       log and the event stream, if open (the classifier callback.)
+    */
+    void result(
+        const cv::Mat* frame,
+        const std::string& fname,
+        const std::vector <cv::Rect>& rects);
+
+    /**
+       Handle a control command (the control callback), one of
+          stats          framerates, latency, queue and performance statistics
+          pause NAME     pause classifiers of given name
+          resume NAME    resume classifiers of given name
+          fps N          change the maximum capture framerate
+          frame          the next annotated frame, as JPEG
+          trace FILE     save the span trace into given file
+    */
+    bool command(const std::string& line, std::string& reply);
+
+    /**
+       Start or stop measuring latency, as control
+       clients come and go (the control callback.)
+    */
+    void meter(const int& clients);
+
+    // Classifier configuration file, and the name of the
+    // source in it (the device index.)
+    const std::string m_config_fname;
+    const std::string m_source;
+
     // Video capture object.
     sherlock::Captor m_captor;
 
@@ -57,14 +216,76 @@ private:
     // Memory deallocate object.
     sherlock::Deallocator m_deallocator;
 
-    // List of classifier objects.
+    // List of classifier workers (input queues are reached through
+    // them; workers of a classifier are listed together), and the
+    // mutex guarding it against reload and control.
     std::list <sherlock::Classifier*> m_classifiers;
+    std::mutex m_classifiers_mutex;
+
+    // Threads loading classifier cascades, and their input queue
+    // of classifiers to load (terminated by one NULL per thread.)
+    std::vector <std::thread> m_loaders;
+    bites::ConcurrentQueue <sherlock::Classifier*> m_load_queue;
+
+    // Configuration file watcher object.
+    sherlock::Watcher m_watcher;
+
+    // Detections log (if open.)
+    sherlock::DetectionLog m_detection_log;
+
+    // Name of file to save the trace into (if any.)
+    std::string m_trace_fname;
+
+    // Detection event stream (if open.)
+    sherlock::EventStream m_events;
+
+    // Control socket (if open.)
+    sherlock::Control m_control;
+
+    // Latency of frames (from capture to release, in msec), measured
+    // only while control clients are connected, and capture times of
+    // frames in flight (with the access mutex.)
+    std::atomic <bool> m_metering;
+    std::mutex m_latency_mutex;
+    std::map <cv::Mat*, Pacer::Clock::time_point> m_capture_times;
+    long m_latency_count;
+    double m_latency_mean;
+    double m_latency_max;
+
+    // Frame pyramids shared by the classifiers.
+    sherlock::PyramidCache m_pyramids;
+
+    // Description of the processing graph instantiated, whether it
+    // has a display, and the number of workers of every classifier.
+    std::string m_graph;
+    bool m_displayed;
+    int m_classifier_threads;
+
+    // Whether classifiers are hosted by batch threads (rather than
+    // running threads of their own), and the batch threads with
+    // their shared input queue.
+    bool m_batched;
+    sherlock::Edge <cv::Mat*> m_batch_queue;
+    std::vector <std::unique_ptr <sherlock::Batch>> m_batches;
+
+    // Whether detections are fused across classifiers, and the
+    // fuser with its input queue (of classifier detections and
+    // END_OF_FRAME markers.)
+    bool m_fused;
+    bites::ConcurrentQueue <Detections*> m_fusion_queue;
+    sherlock::Fuser m_fuser;
+
+    // Placement of classifier threads started.
+    sherlock::Placement m_classifier_placement;
 
     // Shared queues.
-    std::vector< bites::ConcurrentQueue <cv::Mat*>* > m_classifier_inputs;
-    bites::ConcurrentQueue <cv::Mat*> m_display_queue;
+    sherlock::Edge <cv::Mat*> m_display_queue;
     bites::ConcurrentQueue <cv::Mat*> m_done_queue;
-    bites::ConcurrentQueue <Classifier::RectColor> m_rect_colors;
+    bites::ConcurrentQueue <Detections*> m_detections;
+
+    // Detections batches, and colors of classifiers (by index.)
+    sherlock::DetectionsPool m_detections_pool;
+    sherlock::Palette m_palette;
 };
 
 }  // namespace sherlock.
@@ -2,7 +2,11 @@
 #define SHERLOCK_DISPLAYER_HPP_INCLUDED
 
 // Include standard headers.
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 // Include 3rd party headers.
 #include <opencv2/opencv.hpp>
@@ -11,6 +15,9 @@
 // Include application headers.
 #include "Classifier.hpp"
 #include "Captor.hpp"
+#include "Detections.hpp"
+#include "Edge.hpp"
+#include "Placement.hpp"
 
 namespace sherlock {
 
@@ -25,25 +32,78 @@ public:
        
        @param  display_queue    Input queue.
        @param  done_queue       Output queue for processed (or skipped) frames.
-       @param  rect_colors      Input queue of detection perimeters.
+       @param  detections       Input queue of detections batches.
+       @param  pool             Pool to return detections batches to.
+       @param  palette          Colors of classifiers.
        @param  get_capture_fps  Callback to retrieve capture framerate.
     */
     Displayer(
-        bites::ConcurrentQueue <cv::Mat*>& display_queue,
+        Edge <cv::Mat*>& display_queue,
         bites::ConcurrentQueue <cv::Mat*>& done_queue,
-        bites::ConcurrentQueue <Classifier::RectColor>& rect_colors,
+        bites::ConcurrentQueue <Detections*>& detections,
+        DetectionsPool& pool,
+        Palette& palette,
         std::function <std::vector <float> (void)> get_capture_fps
         ):
         m_display_queue   (display_queue),
         m_done_queue      (done_queue),
-        m_rect_colors     (rect_colors),
-        m_get_capture_fps (get_capture_fps)
+        m_detections      (detections),
+        m_pool            (pool),
+        m_palette         (palette),
+        m_get_capture_fps (get_capture_fps),
+        m_window          (true),
+        m_max_width       (0),
+        m_snapshot_requests (0),
+        m_snapshot_count  (0)
         {/* Empty. */}
+
+    /**
+       Show frames in a window (the default), or only annotate
+       them for snapshots.  Must be called before the thread is started.
+    */
+    void setWindow(const bool& window) { m_window = window; }
+
+    /**
+       Limit the width of displayed frames (frames wider are
+       displayed scaled down; not limited if not positive.)
+    */
+    void setMaxWidth(const int& max_width) { m_max_width = max_width; }
+
+    /**
+       Take a snapshot of the next annotated frame, as JPEG.
+       Frames are only annotated (without a window) and encoded
+       while snapshots are requested.
+
+       @param  jpeg          Output JPEG data.
+       @param  timeout_msec  Time to wait for the next frame.
+       @return  False if no frame was displayed in time.
+    */
+    bool snapshot(std::vector <uchar>& jpeg, const int& timeout_msec);
+
+    /**
+       Set the placement applied by the thread as it starts.
+    */
+    void setPlacement(const Placement& placement) { m_placement = placement; }
+
 private:
-    bites::ConcurrentQueue <cv::Mat*>& m_display_queue;
+    Edge <cv::Mat*>& m_display_queue;
     bites::ConcurrentQueue <cv::Mat*>& m_done_queue;
-    bites::ConcurrentQueue <Classifier::RectColor>& m_rect_colors;
+    bites::ConcurrentQueue <Detections*>& m_detections;
+    DetectionsPool& m_pool;
+    Palette& m_palette;
     std::function <std::vector <float> (void)> m_get_capture_fps;
+    Placement m_placement;
+    bool m_window;
+    std::atomic <int> m_max_width;
+
+    // Pending snapshot requests, the latest snapshot and
+    // the number of snapshots taken (with the access mutex.)
+    std::atomic <int> m_snapshot_requests;
+    std::mutex m_snapshot_mutex;
+    std::condition_variable m_snapshot_taken;
+    std::vector <uchar> m_snapshot;
+    long m_snapshot_count;
+
     void run();
 };
 
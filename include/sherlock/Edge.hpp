@@ -0,0 +1,310 @@
+#ifndef SHERLOCK_EDGE_HPP_INCLUDED
+#define SHERLOCK_EDGE_HPP_INCLUDED
+
+// Include standard headers.
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Include application headers.
+#include "Trace.hpp"
+
+namespace sherlock {
+
+/**
+   Overload policy of a pipeline edge, deciding what happens to
+   items pushed while the edge holds *capacity* items already.
+*/
+struct EdgePolicy
+{
+    enum Kind
+    {
+        BLOCK,        /**< block the producer until there is room */
+        DROP_OLDEST,  /**< drop the oldest queued item (freshness) */
+        DROP_NEWEST,  /**< drop the item pushed (completeness of a prefix) */
+        DECIMATE,     /**< pass one of every *decimation* items, dropping oldest */
+        REDUCE,       /**< drop oldest, and have the consumer process
+                           items at reduced resolution while overloaded */
+    };
+    Kind kind = DROP_OLDEST;
+    int capacity = 1;     /**< number of items queued at most */
+    int decimation = 1;   /**< DECIMATE: one item passed of every this many */
+    float scale = 1;      /**< REDUCE: resolution scale when overloaded */
+};
+
+/**
+   Parse an overload policy specification, one of
+      block [CAPACITY]
+      drop_oldest [CAPACITY]
+      drop_newest [CAPACITY]
+      decimate N [CAPACITY]
+      reduce SCALE [CAPACITY]
+   @return  False if the specification is not valid.
+*/
+bool parseEdgePolicy(const std::string& spec, EdgePolicy& policy);
+
+/**
+   Counters of an edge's decisions.
+*/
+struct EdgeCounters
+{
+    long pushed = 0;          /**< items pushed by the producer */
+    long delivered = 0;       /**< items popped by the consumer */
+    long dropped_oldest = 0;  /**< queued items dropped for newer ones */
+    long dropped_newest = 0;  /**< items dropped on push */
+    long decimated = 0;       /**< items dropped by decimation */
+    long blocked = 0;         /**< pushes that blocked the producer */
+    long reduced = 0;         /**< items delivered for reduced processing */
+    long discarded = 0;       /**< queued items discarded on stopping */
+};
+
+/**
+   Print the counters.
+*/
+std::ostream& operator<<(std::ostream& out, const EdgeCounters& counters);
+
+/**
+   Bounded queue between two pipeline stages, applying an overload
+   policy (adjustable at any time) when the consumer falls behind.
+   Items dropped by the policy are handed to the drop callback
+   (e.g. to release frames.)  The value-initialized item (NULL, for
+   pointers) marks the end of processing, and is never dropped.
+*/
+template <typename T>
+class Edge
+{
+public:
+    explicit Edge(const EdgePolicy& policy = EdgePolicy()) :
+        m_policy     (policy),
+        m_arrivals   (0),
+        m_overloaded (false)
+        {/* Empty. */}
+
+    /**
+       Replace the overload policy.
+    */
+    void setPolicy(const EdgePolicy& policy)
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        m_policy = policy;
+        m_popped.notify_all();
+    }
+
+    /**
+       Retrieve the overload policy.
+    */
+    EdgePolicy getPolicy()
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        return m_policy;
+    }
+
+    /**
+       Set the callback invoked with every item dropped.
+       Must be set before items are pushed.
+    */
+    void setDropCallback(std::function <void (const T&)> callback)
+    {
+        m_drop_callback = callback;
+    }
+
+    /**
+       Push an item, applying the overload policy.
+    */
+    void push(const T& item)
+    {
+        std::vector <T> dropped;
+        {
+            std::unique_lock <std::mutex> locker (m_mutex);
+            if (item == T())
+            {
+                m_items.push_back(item);
+                m_pushed.notify_one();
+                return;
+            }
+            ++m_counters.pushed;
+            if (m_policy.kind == EdgePolicy::DECIMATE
+                && m_arrivals++ % std::max(1, m_policy.decimation) != 0)
+            {
+                ++m_counters.decimated;
+                dropped.push_back(item);
+            }
+            else
+            {
+                auto full = [this]() {
+                    return (int)m_items.size() >= std::max(1, m_policy.capacity); };
+                m_overloaded = full() || (m_overloaded && !m_items.empty());
+                if (m_policy.kind == EdgePolicy::BLOCK && full())
+                {
+                    ++m_counters.blocked;
+                    m_popped.wait(locker, [this, &full]() {
+                        return !full() || m_policy.kind != EdgePolicy::BLOCK; });
+                }
+                if (m_policy.kind == EdgePolicy::DROP_NEWEST && full())
+                {
+                    ++m_counters.dropped_newest;
+                    dropped.push_back(item);
+                }
+                else
+                {
+                    while (full())
+                    {
+                        ++m_counters.dropped_oldest;
+                        dropped.push_back(m_items.front());
+                        m_items.pop_front();
+                    }
+                    m_items.push_back(item);
+                    m_pushed.notify_one();
+                }
+            }
+        }
+        if (m_drop_callback)
+        {
+            for (auto& item : dropped)
+            {
+                m_drop_callback(item);
+            }
+        }
+    }
+
+    /**
+       Drop all queued items (through the drop callback),
+       except for the end-of-processing item.
+    */
+    void discard()
+    {
+        std::vector <T> dropped;
+        {
+            std::lock_guard <std::mutex> locker (m_mutex);
+            std::deque <T> kept;
+            for (auto& item : m_items)
+            {
+                if (item == T())
+                {
+                    kept.push_back(item);
+                }
+                else
+                {
+                    dropped.push_back(item);
+                }
+            }
+            m_counters.discarded += dropped.size();
+            m_items.swap(kept);
+            m_popped.notify_all();
+        }
+        if (m_drop_callback)
+        {
+            for (auto& item : dropped)
+            {
+                m_drop_callback(item);
+            }
+        }
+    }
+
+    /**
+       Pop an item, if there is one.
+       @return  False if the edge is empty.
+    */
+    bool try_pop(T& item)
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        if (m_items.empty())
+        {
+            return false;
+        }
+        pop(item);
+        return true;
+    }
+
+    /**
+       Pop an item, waiting for one if necessary.
+    */
+    void wait_and_pop(T& item)
+    {
+        float scale;
+        wait_and_pop(item, scale);
+    }
+
+    /**
+       Pop an item, waiting for one if necessary, with the resolution
+       scale at which to process it: the REDUCE policy's scale while
+       the edge is overloaded, and 1 otherwise.
+    */
+    void wait_and_pop(T& item, float& scale)
+    {
+        Span span ("queue wait");
+        std::unique_lock <std::mutex> locker (m_mutex);
+        m_pushed.wait(locker, [this]() { return !m_items.empty(); });
+        scale = pop(item);
+        span.setFrame(item);
+    }
+
+    /**
+       Return the number of items queued.
+    */
+    size_t size()
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        return m_items.size();
+    }
+
+    /**
+       Return true if the edge is empty.
+    */
+    bool empty()
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        return m_items.empty();
+    }
+
+    /**
+       Retrieve the counters.
+    */
+    EdgeCounters getCounters()
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        return m_counters;
+    }
+
+private:
+    /**
+       Pop the front item (with the mutex held.)
+       @return  The resolution scale at which to process the item.
+    */
+    float pop(T& item)
+    {
+        item = m_items.front();
+        m_items.pop_front();
+        m_popped.notify_all();
+        if (item == T())
+        {
+            return 1;
+        }
+        ++m_counters.delivered;
+        if (m_policy.kind == EdgePolicy::REDUCE && m_overloaded && m_policy.scale < 1)
+        {
+            ++m_counters.reduced;
+            return m_policy.scale;
+        }
+        return 1;
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_pushed;
+    std::condition_variable m_popped;
+    std::deque <T> m_items;
+    EdgePolicy m_policy;
+    EdgeCounters m_counters;
+    std::function <void (const T&)> m_drop_callback;
+    long m_arrivals;
+    bool m_overloaded;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_EDGE_HPP_INCLUDED
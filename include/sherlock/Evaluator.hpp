@@ -0,0 +1,256 @@
+#ifndef SHERLOCK_EVALUATOR_HPP_INCLUDED
+#define SHERLOCK_EVALUATOR_HPP_INCLUDED
+
+// Include standard headers.
+#include <memory>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+// Include application headers.
+#include "Cascade.hpp"
+#include "ExclusionMask.hpp"
+#include "Pyramid.hpp"
+#include "TileCache.hpp"
+
+namespace sherlock {
+
+/**
+   Native evaluator of a compiled (Haar or LBP) cascade.
+
+   Produces the same detections as cv::CascadeClassifier::detectMultiScale
+   for the same cascade and parameters, but works off a shared Pyramid,
+   and evaluates a group of adjacent windows together, tree by tree,
+   so that each tree's feature data is fetched once per group and
+   the per-window arithmetic runs in independent (vectorizable) lanes.
+   Windows are dropped from the group as soon as a stage rejects them.
+   With a tile cache, only windows of changed tiles are grouped, and
+   the candidates of the others carried over from previous frames;
+   with an exclusion mask, windows centered in excluded areas are
+   never grouped.
+
+   An evaluator is not thread-safe; use one per thread.
+*/
+class Evaluator
+{
+public:
+    /**
+       Initialize the evaluator of given cascade.
+       The cascade may be loaded after the evaluator is created.
+    */
+    explicit Evaluator(const Cascade& cascade) :
+        m_cascade (cascade),
+        m_stride  (-1)
+        {/* Empty. */}
+
+    /**
+       Cache results over given tiling (see TileCache.)
+    */
+    void setTiles(const TileCache::Parameters& params) { m_tiles.setParameters(params); }
+
+    /**
+       Skip windows centered in the excluded areas of given mask
+       (none if NULL.)
+    */
+    void setExclusion(const std::shared_ptr <const ExclusionMask>& mask);
+
+    /**
+       Retrieve the statistics of the tile cache.
+    */
+    TileCache::Stats getTileStats() const { return m_tiles.getStats(); }
+
+    /**
+       Detect objects in the frame of given pyramid, with the same
+       semantics as cv::CascadeClassifier::detectMultiScale (using
+       the pyramid's scale factor.)
+
+       @param  pyramid        Pyramid of the frame.
+       @param  objects        Output detected objects.
+       @param  min_neighbors  Number of neighbors each candidate rectangle retains.
+       @param  min_size       Minimum possible object size.
+       @param  max_size       Maximum possible object size.
+    */
+    void detectMultiScale(
+        Pyramid& pyramid,
+        std::vector <cv::Rect>& objects,
+        const int& min_neighbors,
+        const cv::Size& min_size,
+        cv::Size max_size);
+
+    /**
+       Append candidate windows (in frame coordinates) at given
+       pyramid level to *candidates*, without grouping (nor
+       scanning windows of tiles unchanged, with a tile cache,
+       or windows excluded.)
+
+       @return  False if the level is too small for the cascade window.
+    */
+    bool detectSingleScale(
+        Pyramid& pyramid,
+        const int& level,
+        std::vector <cv::Rect>& candidates);
+
+    /**
+       Detection limits of one evaluator in a batch.
+    */
+    struct Limits
+    {
+        int min_neighbors;     /**< neighbors each candidate rectangle retains */
+        cv::Size min_size;     /**< minimum possible object size */
+        cv::Size max_size;     /**< maximum possible object size */
+    };
+
+    /**
+       Detect objects of several cascades in a single sweep over the
+       pyramid.  Each group of window positions is visited once, and
+       tested against the first stage of every cascade before any of
+       them descends into its remaining stages.  The detections of each
+       evaluator are the same as detectMultiScale would produce
+       (each evaluator caching over its own tiles.)
+
+       @param  pyramid     Pyramid of the frame.
+       @param  evaluators  The evaluators (of distinct cascades.)
+       @param  limits      Detection limits, one per evaluator.
+       @param  objects     Output detected objects, one vector per evaluator.
+    */
+    static void detectBatch(
+        Pyramid& pyramid,
+        const std::vector <Evaluator*>& evaluators,
+        const std::vector <Limits>& limits,
+        std::vector <std::vector <cv::Rect>>& objects);
+
+    /**
+       Number of adjacent windows evaluated together.
+    */
+    static const int LANES = 8;
+
+    /**
+       A group of windows (of one row) under evaluation.
+    */
+    struct Windows
+    {
+        int count;                 /**< number of windows in the group */
+        int x[LANES];              /**< window positions in the row */
+        int base[LANES];           /**< offsets of windows in integral images */
+        int sq_base[LANES];        /**< offsets of windows in squared integral */
+        double inv_norm[LANES];    /**< inverse variance normalization factors */
+        double sums[LANES];        /**< stage sums */
+    };
+
+    /**
+       Prepare for evaluating windows at given pyramid level.
+       @return  False if the level is too small for the cascade window.
+    */
+    bool setLevel(Pyramid& pyramid, const int& level);
+
+    /**
+       Compute window offsets (and normalization factors) of
+       windows at given positions of row *y* of the current level.
+    */
+    void setWindows(Windows& windows, const int& y) const;
+
+    /**
+       Evaluate given stage on the windows, filling in their stage sums.
+    */
+    void evalStage(const int& stage, Windows& windows) const;
+
+    /**
+       Remove windows rejected by given stage (by their stage sums.)
+    */
+    void rejectWindows(const int& stage, Windows& windows) const;
+
+private:
+    const Cascade& m_cascade;
+
+    // Integral images of the current level.
+    const int* m_sum;
+    const int* m_tilted;
+    const double* m_sqsum;
+    int m_sq_stride;
+
+    // Corner offsets of all features (12 per Haar feature,
+    // 16 per LBP feature) and the Haar feature source images,
+    // valid for the row stride they were computed for.
+    std::vector <int> m_offsets;
+    std::vector <char> m_is_tilted;
+    int m_stride;
+
+    // Corner offsets of the variance normalization rectangle.
+    int m_norm[4];
+    int m_sq_norm[4];
+    double m_norm_area;
+
+    // Cache of results over tiles.
+    TileCache m_tiles;
+
+    // Exclusion mask, rendered at the size of the frame scanned
+    // (empty if none), and whether every row of it is excluded.
+    std::shared_ptr <const ExclusionMask> m_exclusion;
+    cv::Mat m_excluded;
+    std::vector <char> m_excluded_rows;
+
+    /**
+       Evaluate the first stage on the windows, removing those rejected,
+       and those skipped after a rejection (as in a sequential scan.)
+       @param  skip  Position to be skipped (if any, -1 otherwise);
+                     carried across the groups of a row.
+       @param  step  Distance between positions of the row.
+    */
+    void evalFirstStage(Windows& windows, int& skip, const int& step) const;
+
+    /**
+       Start a scan of the pyramid, with given size limits
+       (updating the tile cache and the exclusion mask.)
+    */
+    void startScan(Pyramid& pyramid, const cv::Size& min_size, const cv::Size& max_size);
+
+    /**
+       Return true if the window at given position of given level
+       (of given size in frame coordinates) is to be scanned.
+    */
+    bool isScanned(const int& x, const int& y, const double& factor, const cv::Size& size) const
+    {
+        if (!m_tiles.isEnabled() && m_excluded.empty())
+        {
+            return true;
+        }
+        cv::Rect window (cvRound(x * factor), cvRound(y * factor), size.width, size.height);
+        if (!m_excluded.empty() && m_excluded.at<uchar>(
+                std::min(m_excluded.rows - 1, window.y + window.height / 2),
+                std::min(m_excluded.cols - 1, window.x + window.width / 2)))
+        {
+            return false;
+        }
+        return m_tiles.isScanned(window);
+    }
+
+    /**
+       Return true if any window in given row of given level
+       (of given size in frame coordinates) is to be scanned.
+    */
+    bool isRowScanned(const int& y, const double& factor, const cv::Size& size) const
+    {
+        int top = cvRound(y * factor);
+        if (!m_excluded_rows.empty() && m_excluded_rows[
+                std::min((int)m_excluded_rows.size() - 1, top + size.height / 2)])
+        {
+            return false;
+        }
+        return m_tiles.isScanned(top, top + size.height);
+    }
+
+    /**
+       Evaluate the remaining stages while any windows remain.
+    */
+    void evalRemainingStages(Windows& windows) const;
+
+    /**
+       Compute feature offsets for given row stride.
+    */
+    void setStride(const int& stride);
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_EVALUATOR_HPP_INCLUDED
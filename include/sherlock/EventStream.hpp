@@ -0,0 +1,137 @@
+#ifndef SHERLOCK_EVENTSTREAM_HPP_INCLUDED
+#define SHERLOCK_EVENTSTREAM_HPP_INCLUDED
+
+// Include standard headers.
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <boost/date_time.hpp>
+#include <opencv2/opencv.hpp>
+#include <bites.hpp>
+
+namespace sherlock {
+
+/**
+   Detection event stream thread, publishing every detection
+   to subscribers connected on a Unix-domain or TCP socket.
+
+   Events are encoded as they are published (by the classifier
+   threads), and sent in batches by the stream thread.  Each
+   subscriber has a bounded send buffer; subscribers falling
+   behind by more than the buffer are disconnected, so that
+   slow subscribers never stall the pipeline.
+*/
+class EventStream : public bites::Thread
+{
+public:
+    /**
+       Encoding of events.
+    */
+    enum Format
+    {
+        JSON,     /**< one JSON object per line */
+        BINARY,   /**< length-prefixed binary records (see encode) */
+    };
+
+    /**
+       A detection event.
+    */
+    struct Event
+    {
+        int64_t frame;            /**< frame sequence number */
+        int64_t time;             /**< capture time (usec since the epoch) */
+        std::string classifier;   /**< classifier name (from the configuration) */
+        cv::Rect rect;            /**< detected object */
+    };
+
+    EventStream();
+    ~EventStream();
+
+    /**
+       Create the socket at given address, either
+          unix:PATH
+          tcp:PORT        (on the loopback interface)
+          tcp:HOST:PORT
+       @return  False if the socket could not be created.
+    */
+    bool open(const std::string& address, const Format& format);
+
+    /**
+       Return true if the socket was created.
+    */
+    bool isOpen() const { return m_listen_fd >= 0; }
+
+    /**
+       Number the newly captured frame, with its capture time.
+    */
+    void capture(const cv::Mat* frame, const boost::posix_time::ptime& tstamp);
+
+    /**
+       Publish the detections of a classifier in given frame.
+    */
+    void publish(
+        const cv::Mat* frame,
+        const std::string& classifier,
+        const std::vector <cv::Rect>& rects);
+
+    /**
+       Forget given frame (which is released.)
+    */
+    void release(const cv::Mat* frame);
+
+    /**
+       Signal the stream thread to stop (disconnecting all subscribers.)
+    */
+    void stop();
+
+    /**
+       Encode an event, appending to *out*.  Binary records are
+          uint32 length of the rest of the record
+          int64  frame, int64 time
+          int16  x, y, width, height
+          uint8  length of classifier name, and the name
+       with all integers little-endian.
+    */
+    static void encode(const Event& event, const Format& format, std::string& out);
+
+    /**
+       Decode a binary record from the start of given data.
+       @return  The size of the record, or 0 if incomplete.
+    */
+    static size_t decode(const char* data, const size_t& size, Event& event);
+
+    /**
+       Connect to an event stream at given address (see open.)
+       @return  The socket, or -1 on failure.
+    */
+    static int connect(const std::string& address);
+
+private:
+    Format m_format;
+    std::string m_path;
+    int m_listen_fd;
+
+    // Event descriptor used to wake up the thread for stopping.
+    int m_stop_fd;
+
+    // Number of subscribers (nothing is encoded while there are none.)
+    std::atomic <int> m_subscribers;
+
+    // Sequence numbers and capture times of frames in flight, the
+    // events pending to be sent, and the access mutex of both.
+    std::mutex m_mutex;
+    int64_t m_count;
+    std::map <const cv::Mat*, std::pair <int64_t, int64_t>> m_frames;
+    std::string m_pending;
+
+    void run();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_EVENTSTREAM_HPP_INCLUDED
@@ -0,0 +1,56 @@
+#ifndef SHERLOCK_EXCLUSIONMASK_HPP_INCLUDED
+#define SHERLOCK_EXCLUSIONMASK_HPP_INCLUDED
+
+// Include standard headers.
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Areas of a source's view never containing objects (e.g. sky,
+   walls and ceilings), as polygons and a bitmap, independent of
+   the frame size.  Windows centered in excluded areas are not
+   scanned at all.
+*/
+struct ExclusionMask
+{
+    std::vector <std::vector <cv::Point2f>> polygons;  /**< excluded polygons, in
+                                                            ratios of frame width
+                                                            and height */
+    cv::Mat bitmap;  /**< grayscale image, excluded where nonzero,
+                          stretched over the frame (none if empty) */
+
+    /**
+       Return true if nothing is excluded.
+    */
+    bool empty() const { return polygons.empty() && bitmap.empty(); }
+
+    /**
+       Return true if given point (in ratios of frame width
+       and height) is excluded.
+    */
+    bool excludes(const cv::Point2f& point) const;
+
+    /**
+       Render the mask at given frame size (255 where excluded.)
+    */
+    void render(const cv::Size& size, cv::Mat& mask) const;
+};
+
+/**
+   Parse an exclusion mask specification, any number of
+      polygon X,Y X,Y X,Y ...   polygon of at least three points, in
+                                ratios of frame width and height
+      bitmap FILE               image file, excluded where nonzero
+                                (scaled to the frame)
+   @return  False if the specification (or the bitmap) is not valid.
+*/
+bool parseExclusionMask(const std::string& spec, ExclusionMask& mask);
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_EXCLUSIONMASK_HPP_INCLUDED
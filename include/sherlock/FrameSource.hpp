@@ -0,0 +1,197 @@
+#ifndef SHERLOCK_FRAMESOURCE_HPP_INCLUDED
+#define SHERLOCK_FRAMESOURCE_HPP_INCLUDED
+
+// Include standard headers.
+#include <atomic>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+#include <bites.hpp>
+
+// Include application headers.
+#include "Edge.hpp"
+#include "Pacer.hpp"
+
+namespace sherlock {
+
+/**
+   Frame source read by a Multiplexer: a file descriptor signalling
+   (by becoming readable) that a frame can be read without blocking.
+   Frames are pushed onto the output queues as they complete, the
+   consumer taking ownership (frames are deleted if there is none.)
+*/
+class FrameSource
+{
+public:
+    /**
+       Initialize the source.
+
+       @param  name     Name of source (for reports.)
+       @param  max_fps  Maximum FPS rate limit.
+       @param  live     Whether frames arrive at a rate of their own
+                        (and are dropped ahead of the deadline), rather
+                        than as fast as read (and are not read ahead.)
+    */
+    FrameSource(const std::string& name, const float& max_fps, const bool& live);
+    virtual ~FrameSource() {/* Empty. */}
+
+    /**
+       Open the source.
+       @return  False on failure.
+    */
+    virtual bool open() = 0;
+
+    /**
+       Return the file descriptor of the source (once open.)
+    */
+    virtual int getFd() const = 0;
+
+    /**
+       Read what is available of the next frame, without blocking,
+       setting the end of the stream when reached.
+
+       @param  discard  Whether to discard the frame (when not due.)
+       @return  The frame, once complete (and kept), or NULL.
+    */
+    virtual cv::Mat* read(const bool& discard) = 0;
+
+    /**
+       Return the name of the source.
+    */
+    const std::string& getName() const { return m_name; }
+
+    /**
+       Return true if frames arrive at a rate of their own.
+    */
+    bool isLive() const { return m_live; }
+
+    /**
+       Return true if the end of the stream was reached.
+    */
+    bool isEnded() const { return m_ended; }
+
+    /**
+       Add an output queue for frames (before the multiplexer starts.)
+    */
+    void addOutput(Edge <cv::Mat*>& output) { m_outputs.push_back(&output); }
+
+    /**
+       Push a frame (or the end of processing, if NULL)
+       onto all output queues.
+    */
+    void push(cv::Mat* frame);
+
+    /**
+       Return the pacer observing the maximum framerate.
+    */
+    Pacer& getPacer() { return m_pacer; }
+
+    /**
+       Return the number of frames pushed.
+    */
+    long getCount() const { return m_count; }
+
+    /**
+       Retrieve the current framerate.
+    */
+    std::vector <float> getFramerate() { return m_framerate.get(); }
+
+protected:
+    bool m_ended;
+
+private:
+    const std::string m_name;
+    const bool m_live;
+    Pacer m_pacer;
+    std::vector <Edge <cv::Mat*>*> m_outputs;
+    std::atomic <long> m_count;
+    bites::RateTicker m_ticker;
+    bites::Mutexed <std::vector <float>> m_framerate;
+};
+
+/**
+   Source of raw BGR frames (of given size, back to back) read from
+   a file, a named pipe, or the standard input (e.g. as written by
+   ffmpeg -f rawvideo -pix_fmt bgr24.)  Frames are read as fast as
+   due; partial frames are accumulated over several reads.
+*/
+class RawSource : public FrameSource
+{
+public:
+    /**
+       @param  fname    Name of file (or "-" for the standard input.)
+       @param  width    Width of frames.
+       @param  height   Height of frames.
+       @param  max_fps  Maximum FPS rate limit.
+    */
+    RawSource(
+        const std::string& fname,
+        const int& width,
+        const int& height,
+        const float& max_fps = std::numeric_limits<float>::max()
+        );
+    ~RawSource();
+
+    bool open();
+    int getFd() const { return m_fd; }
+    cv::Mat* read(const bool& discard);
+
+private:
+    const std::string m_fname;
+    const int m_width;
+    const int m_height;
+    int m_fd;
+
+    // The frame being read, and the number of bytes read so far.
+    cv::Mat* m_frame;
+    size_t m_filled;
+};
+
+/**
+   Video4Linux capture device, streaming YUYV frames through
+   memory-mapped buffers (converted to BGR as dequeued.)
+*/
+class V4L2Source : public FrameSource
+{
+public:
+    /**
+       @param  device   Path of device (e.g. /dev/video0.)
+       @param  width    Requested width of video.
+       @param  height   Requested height of video.
+       @param  max_fps  Maximum FPS rate limit.
+    */
+    V4L2Source(
+        const std::string& device,
+        const int& width,
+        const int& height,
+        const float& max_fps = std::numeric_limits<float>::max()
+        );
+    ~V4L2Source();
+
+    bool open();
+    int getFd() const { return m_fd; }
+    cv::Mat* read(const bool& discard);
+
+private:
+    const std::string m_device;
+    int m_width;
+    int m_height;
+    size_t m_stride;  // Bytes per row of the buffers.
+    int m_fd;
+    bool m_streaming;
+
+    // The memory-mapped buffers.
+    struct Buffer
+    {
+        void* start;
+        size_t length;
+    };
+    std::vector <Buffer> m_buffers;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_FRAMESOURCE_HPP_INCLUDED
@@ -0,0 +1,106 @@
+#ifndef SHERLOCK_FUSER_HPP_INCLUDED
+#define SHERLOCK_FUSER_HPP_INCLUDED
+
+// Include standard headers.
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+#include <bites.hpp>
+
+// Include application headers.
+#include "Detections.hpp"
+#include "Placement.hpp"
+
+namespace sherlock {
+
+/**
+   Fusion thread, merging the detections of all classifiers
+   in each frame into a single deduplicated set.
+
+   Batches of a frame are collected until the frame is released
+   (marked by an END_OF_FRAME batch), then fused by non-maximum
+   suppression: detections overlapping (by intersection over union)
+   the best-supported remaining detection are merged into one,
+   averaging their rectangles.  The confidence of a fused detection
+   is the fraction of classifiers (reporting on the frame) that
+   voted for it, and detections with too few votes are discarded.
+*/
+class Fuser : public bites::Thread
+{
+public:
+    /**
+       Fusion parameters, adjustable while the fuser runs.
+    */
+    struct Parameters
+    {
+        float iou;     /**< overlap (intersection over union) of duplicates */
+        int votes;     /**< classifiers needed to agree on a detection */
+
+        Parameters() : iou (0.4), votes (1) {/* Empty. */}
+    };
+
+    /**
+       Initialize the fuser with I/O queues.
+       @param  input_queue   Input queue of detections batches
+                             (and END_OF_FRAME markers.)
+       @param  output_queue  Output queue of fused batches.
+       @param  pool          Pool of detections batches.
+       @param  params        Fusion parameters.
+    */
+    Fuser(
+        bites::ConcurrentQueue <Detections*>& input_queue,
+        bites::ConcurrentQueue <Detections*>& output_queue,
+        DetectionsPool& pool,
+        const Parameters& params = Parameters()
+        ):
+        m_input_queue  (input_queue),
+        m_output_queue (output_queue),
+        m_pool         (pool)
+        {
+            setParameters(params);
+        }
+
+    void setParameters(const Parameters& params) { m_params.set(params); }
+    Parameters getParameters() { return m_params.get(); }
+
+    /**
+       Set the placement applied by the thread as it starts.
+    */
+    void setPlacement(const Placement& placement) { m_placement = placement; }
+
+    /**
+       Fuse given batches of a frame into *fused*.
+    */
+    void fuse(
+        const std::vector <Detections*>& batches,
+        const Parameters& params,
+        Detections& fused);
+
+private:
+    bites::ConcurrentQueue <Detections*>& m_input_queue;
+    bites::ConcurrentQueue <Detections*>& m_output_queue;
+    DetectionsPool& m_pool;
+    bites::Mutexed <Parameters> m_params;
+    Placement m_placement;
+
+    // Candidate detections of the frame being fused,
+    // in structure-of-arrays layout.
+    std::vector <float> m_x1, m_y1, m_x2, m_y2, m_area;
+    std::vector <int> m_label;
+    std::vector <float> m_overlap;
+    std::vector <float> m_support;
+    std::vector <int> m_order;
+    std::vector <char> m_suppressed;
+
+    /**
+       Compute the overlaps of candidate *index* with all candidates.
+    */
+    void computeOverlaps(const int& index);
+
+    void run();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_FUSER_HPP_INCLUDED
@@ -0,0 +1,88 @@
+#ifndef SHERLOCK_GRAPH_HPP_INCLUDED
+#define SHERLOCK_GRAPH_HPP_INCLUDED
+
+// Include standard headers.
+#include <string>
+#include <vector>
+
+// Include application headers.
+#include "Edge.hpp"
+#include "Placement.hpp"
+
+namespace sherlock {
+
+/**
+   A stage of the processing graph: its kind, the stage feeding
+   it (through an edge of given overload policy), and the number
+   and placement of the threads running it.
+*/
+struct GraphStage
+{
+    enum Kind
+    {
+        CAPTURE,       /**< the source of frames */
+        DISPLAY,       /**< displays frames (from capture) with detections */
+        CLASSIFIERS,   /**< threads of every classifier (frames from capture) */
+        BATCH,         /**< threads hosting all classifiers (frames from capture) */
+        FUSION,        /**< fuses detections (from classifiers or batch) */
+    };
+    std::string name;
+    Kind kind = CAPTURE;
+    std::string input;            /**< name of the stage feeding this one */
+    EdgePolicy policy;            /**< overload policy of the input edge */
+    bool has_policy = false;      /**< whether the policy is given */
+    int threads = 1;              /**< number of threads (per classifier,
+                                       for classifiers) */
+    Placement placement;          /**< placement of the threads */
+    bool has_placement = false;   /**< whether the placement is given */
+};
+
+/**
+   The processing graph: the stages instantiated by the Detector.
+   Frames flow from the capture stage to the display and to either
+   the classifiers or the batch; detections flow from these to the
+   display, through fusion if present.
+*/
+struct Graph
+{
+    std::vector <GraphStage> stages;
+
+    /**
+       Return the stage of given kind, or NULL if there is none.
+    */
+    const GraphStage* find(const GraphStage::Kind& kind) const;
+
+    /**
+       Return the stage of given name, or NULL if there is none.
+    */
+    const GraphStage* get(const std::string& name) const;
+};
+
+/**
+   Parse a graph stage specification:
+      KIND [input STAGE] [threads N] [policy POLICY] [placement PLACEMENT]
+   where KIND is one of capture, display, classifiers, batch or fusion,
+   and POLICY and PLACEMENT are as parsed by parseEdgePolicy and
+   parsePlacement.
+   @return  False if the specification is not valid.
+*/
+bool parseGraphStage(const std::string& spec, GraphStage& stage);
+
+/**
+   Check that the graph is one the Detector can instantiate: a single
+   capture stage, at most one stage of every other kind, either
+   classifiers or batch, and every stage fed by a stage of the kind
+   it takes its input from.  The input of a stage may be left out if
+   there is a single candidate.
+   @return  False (with the reason in *error*) if the graph is not valid.
+*/
+bool checkGraph(Graph& graph, std::string& error);
+
+/**
+   Describe the graph, one stage per line.
+*/
+std::string describeGraph(const Graph& graph);
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_GRAPH_HPP_INCLUDED
@@ -0,0 +1,146 @@
+#ifndef SHERLOCK_MATPOOL_HPP_INCLUDED
+#define SHERLOCK_MATPOOL_HPP_INCLUDED
+
+// Include standard headers.
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Pooling allocator of matrix data, for frames and the per-frame
+   temporaries derived from them (pyramids, differences, canvases.)
+
+   Buffers are rounded up to size classes (four per power of two)
+   and recycled, never returned to the system: once every stage has
+   seen its largest matrices, processing allocates nothing from the
+   heap.  Every thread allocates from an arena of its own, without
+   locking; buffers released by other threads (e.g. frames released
+   by the deallocator) are handed back to the arena they came from,
+   hence stay on the allocating thread's NUMA node.
+
+   Matrices use the pool only if attached to it while empty;
+   allocations are counted per stage, as named by each thread.
+*/
+class MatPool : public cv::MatAllocator
+{
+public:
+    /**
+       Return the pool (of the process.)
+    */
+    static MatPool& instance();
+
+    /**
+       Attach given matrix to the pool (releasing its data, if any),
+       so that its data, and data of matrices created in it
+       (e.g. as output of OpenCV functions), come from the pool.
+    */
+    static void attach(cv::Mat& mat);
+
+    /**
+       Count allocations of the calling thread under given stage
+       (threads not naming theirs are counted as "other".)
+    */
+    static void setStage(const std::string& name);
+
+    /**
+       Allocation counters of a stage.
+    */
+    struct Counters
+    {
+        long allocations = 0;   /**< buffers allocated */
+        long reused = 0;        /**< of which recycled from the pool */
+        long heap = 0;          /**< of which allocated from the heap */
+        long heap_bytes = 0;    /**< bytes allocated from the heap */
+    };
+
+    /**
+       Return the counters of all stages (by stage name.)
+    */
+    std::map <std::string, Counters> getCounters();
+
+    // Implement cv::MatAllocator.
+    void allocate(
+        int dims,
+        const int* sizes,
+        int type,
+        int*& refcount,
+        uchar*& datastart,
+        uchar*& data,
+        size_t* step);
+    void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    /**
+       Number of size classes (larger buffers are not pooled.)
+    */
+    static const int CLASSES = 93;
+
+    /**
+       Header of a buffer.
+    */
+    struct Block;
+
+    /**
+       Free buffers (by size class) of a thread.
+    */
+    struct Arena
+    {
+        Arena();
+        Block* local[CLASSES];             /**< released by the owner thread */
+        Block* remote[CLASSES];            /**< released by other threads */
+        std::mutex mutex;                  /**< guards remote blocks */
+        std::atomic <bool> has_remote;     /**< whether remote blocks are waiting */
+        std::atomic <bool> in_use;         /**< whether owned by a thread */
+    };
+
+private:
+    MatPool() {/* Empty. */}
+
+    /**
+       Return the arena of the calling thread.
+    */
+    Arena& getArena();
+
+    /**
+       Counters of a stage, updated by any number of threads.
+    */
+    struct Stage
+    {
+        Stage() : allocations (0), reused (0), heap (0), heap_bytes (0) {/* Empty. */}
+        std::atomic <long> allocations;
+        std::atomic <long> reused;
+        std::atomic <long> heap;
+        std::atomic <long> heap_bytes;
+    };
+
+    /**
+       Return the stage of the calling thread.
+    */
+    Stage& getStage();
+
+    /**
+       Move blocks released to the arena by other threads
+       to its own free lists.
+    */
+    void reclaim(Arena& arena);
+
+    std::mutex m_mutex;
+    std::list <Arena> m_arenas;
+    std::map <std::string, Stage> m_stages;
+};
+
+/**
+   Print the counters.
+*/
+std::ostream& operator<<(std::ostream& out, const MatPool::Counters& counters);
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_MATPOOL_HPP_INCLUDED
@@ -0,0 +1,75 @@
+#ifndef SHERLOCK_MULTIPLEXER_HPP_INCLUDED
+#define SHERLOCK_MULTIPLEXER_HPP_INCLUDED
+
+// Include standard headers.
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Include 3rd party headers.
+#include <bites.hpp>
+
+// Include application headers.
+#include "FrameSource.hpp"
+#include "Placement.hpp"
+
+namespace sherlock {
+
+/**
+   Capture thread multiplexing many sources: waits (with epoll) for
+   whichever source has a frame ready, and pushes it onto that source's
+   outputs.  Sources are paced by deadlines rather than by sleeping, so
+   one thread serves any number of low-rate cameras; descriptors epoll
+   cannot wait on (regular files) are read whenever due.
+*/
+class Multiplexer : public bites::Thread
+{
+public:
+    /**
+       @param  duration  Duration of capture (in seconds;
+                         until stopped, if not positive.)
+    */
+    explicit Multiplexer(const int& duration = 0);
+    ~Multiplexer();
+
+    /**
+       Add a source, taking ownership (before the thread is started.)
+    */
+    void addSource(FrameSource* source) { m_sources.push_back(std::unique_ptr <FrameSource> (source)); }
+
+    /**
+       Return the sources.
+    */
+    const std::vector <std::unique_ptr <FrameSource>>& getSources() const { return m_sources; }
+
+    /**
+       Signal the thread to stop, pushing the end of processing
+       onto the outputs of all sources (may be called from a
+       signal handler.)
+    */
+    void stop();
+
+    /**
+       Set the placement applied by the thread as it starts.
+    */
+    void setPlacement(const Placement& placement) { m_placement = placement; }
+
+    /**
+       Print the frame counts and pacing statistics of the sources.
+    */
+    void report(std::ostream& out);
+
+private:
+    const int m_duration;
+    Placement m_placement;
+    std::vector <std::unique_ptr <FrameSource>> m_sources;
+
+    // Event descriptor used to wake up the thread for stopping.
+    int m_stop_fd;
+
+    void run();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_MULTIPLEXER_HPP_INCLUDED
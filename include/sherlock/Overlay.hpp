@@ -0,0 +1,80 @@
+#ifndef SHERLOCK_OVERLAY_HPP_INCLUDED
+#define SHERLOCK_OVERLAY_HPP_INCLUDED
+
+// Include standard headers.
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+// Include application headers.
+#include "Detections.hpp"
+
+namespace sherlock {
+
+/**
+   Overlay of detections and on-screen-display text, kept apart
+   from the frames, which are never drawn on (and hence may be read
+   by any number of threads while displayed.)
+
+   The overlay holds the latest detections of every classifier
+   (in frame coordinates), until replaced by newer ones or held
+   for too many displayed frames.  Rendering composites a frame
+   with the overlay at display resolution: the frame is scaled
+   straight into the output, and the overlay drawn on top.
+*/
+class Overlay
+{
+public:
+    /**
+       Initialize the overlay.
+       @param  hold  Number of frames detections are displayed
+                     for, unless replaced earlier.
+    */
+    explicit Overlay(const int& hold = 15) :
+        m_hold (hold)
+        {/* Empty. */}
+
+    /**
+       Replace the detections of the batch's classifier
+       (or all detections, with a fused batch.)
+    */
+    void update(const Detections& detections);
+
+    /**
+       Render the frame, with the overlay, into *output*.
+
+       @param  frame    The frame (only read.)
+       @param  size     Display size.
+       @param  palette  Colors of classifiers.
+       @param  lines    Lines of on-screen-display text.
+       @param  output   Output image (reused across frames.)
+    */
+    void render(
+        const cv::Mat& frame,
+        const cv::Size& size,
+        Palette& palette,
+        const std::list <std::string>& lines,
+        cv::Mat& output);
+
+private:
+    /**
+       Detections of a classifier.
+    */
+    struct Layer
+    {
+        std::vector <cv::Rect> rects;
+        std::vector <int> classifiers;
+        int age;
+    };
+
+    const int m_hold;
+    std::map <int, Layer> m_layers;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_OVERLAY_HPP_INCLUDED
@@ -0,0 +1,115 @@
+#ifndef SHERLOCK_PACER_HPP_INCLUDED
+#define SHERLOCK_PACER_HPP_INCLUDED
+
+// Include standard headers.
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+
+namespace sherlock {
+
+/**
+   Frame pacer, capping a loop at a maximum framerate.
+
+   Runs on the monotonic clock, and sleeps until absolute deadlines
+   spaced exactly one interval apart, so that neither sleeping late
+   nor the time spent in the loop body accumulates as drift.
+   If the loop falls behind by more than an interval, the schedule
+   restarts from the present, rather than bursting to catch up.
+   Keeps statistics of wakeup jitter (lateness past the deadline.)
+*/
+class Pacer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+       Jitter statistics, in microseconds.
+    */
+    struct Stats
+    {
+        long count;     /**< number of paced frames */
+        long missed;    /**< number of deadlines missed by over an interval */
+        double mean;    /**< mean jitter */
+        double stddev;  /**< standard deviation of jitter */
+        double max;     /**< maximum jitter */
+    };
+
+    /**
+       Initialize the pacer with maximum framerate
+       (not pacing at all if infinite or not positive.)
+    */
+    explicit Pacer(const float& max_fps = std::numeric_limits<float>::max());
+
+    /**
+       Change the maximum framerate (taking effect
+       from the next deadline on.)
+    */
+    void setMaxFps(const float& max_fps);
+
+    /**
+       Wait for the next frame's deadline (the first call returns
+       immediately), or until *stopping* is set, if given.
+       @return  False if stopped before the deadline.
+    */
+    bool wait(const std::atomic <bool>* stopping = NULL);
+
+    /**
+       Return the next frame's deadline, without waiting (the
+       earliest time point, if not pacing, or for the first frame.)
+       For loops waiting on other events than time.
+    */
+    Clock::time_point getDeadline();
+
+    /**
+       Account for a frame taken at the present (at or past
+       the deadline), and schedule the next deadline.
+    */
+    void advance();
+
+    /**
+       Retrieve the jitter statistics.
+    */
+    Stats getStats();
+
+    /**
+       Print the jitter statistics.
+    */
+    void report(std::ostream& out);
+
+    /**
+       Return the current monotonic time.
+    */
+    static Clock::time_point now() { return Clock::now(); }
+
+    /**
+       Sleep until given monotonic time, or until *stopping* is set,
+       if given (polled every few tens of milliseconds, so that the
+       flag may be set from a signal handler.)
+       @return  False if stopped before the deadline.
+    */
+    static bool sleepUntil(
+        const Clock::time_point& deadline,
+        const std::atomic <bool>* stopping = NULL);
+
+private:
+    bool m_paced;
+    Clock::duration m_interval;
+    Clock::time_point m_deadline;
+    bool m_started;
+
+    // Running jitter statistics (Welford's), and the access
+    // mutex (also of the framerate, which may change.)
+    std::mutex m_mutex;
+    long m_count;
+    long m_missed;
+    double m_mean;
+    double m_m2;
+    double m_max;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_PACER_HPP_INCLUDED
@@ -0,0 +1,76 @@
+#ifndef SHERLOCK_PERFCOUNTERS_HPP_INCLUDED
+#define SHERLOCK_PERFCOUNTERS_HPP_INCLUDED
+
+// Include standard headers.
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace sherlock {
+
+/**
+   Hardware performance counters of pipeline stages (per thread, with
+   perf_event_open), aggregated per stage over the frames processed:
+   whether a stage is compute-bound (cycles, instructions), misses the
+   cache on frames (last-level cache misses), or contends for CPUs
+   with other threads (context switches.)
+
+   Counting is optional (see setEnabled); counters that cannot be
+   opened (no hardware support, or perf_event_paranoid too strict,
+   e.g. above 1 for context switches, counted in the kernel) are
+   reported as unavailable, and the others counted regardless.
+*/
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        LLC_MISSES,
+        CONTEXT_SWITCHES,
+        COUNTERS,  /**< number of counters */
+    };
+
+    /**
+       Counts of a stage over the frames processed.
+    */
+    struct Totals
+    {
+        long frames = 0;
+        uint64_t values[COUNTERS] = {};
+        bool available[COUNTERS] = {};
+    };
+
+    /**
+       Enable counting by threads attaching afterwards.
+    */
+    static void setEnabled(const bool& enabled);
+
+    /**
+       Count the events of the calling thread for given stage
+       (if enabled.)  Counters are closed as the thread exits.
+    */
+    static void attach(const std::string& stage);
+
+    /**
+       Account the events of the calling thread, since the
+       previous frame, to a frame of its stage.
+    */
+    static void frameDone();
+
+    /**
+       Retrieve the counts of every stage.
+    */
+    static std::map <std::string, Totals> getTotals();
+};
+
+/**
+   Print counts per frame (and instructions per cycle.)
+*/
+std::ostream& operator<<(std::ostream& out, const PerfCounters::Totals& totals);
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_PERFCOUNTERS_HPP_INCLUDED
@@ -0,0 +1,194 @@
+#ifndef SHERLOCK_PIPELINE_HPP_INCLUDED
+#define SHERLOCK_PIPELINE_HPP_INCLUDED
+
+// Include standard headers.
+#include <atomic>
+#include <limits>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+#include <bites.hpp>
+
+// Include application headers.
+#include "Edge.hpp"
+
+namespace sherlock {
+
+/**
+   Frame passed along the stages of a pipeline
+   (and recycled, buffers and all, at its end.)
+*/
+struct Frame
+{
+    cv::Mat image;                  /**< the image, as transformed by stages */
+    double alpha = 1;               /**< weight of the frame in running averages */
+    std::list <std::string> osd;    /**< lines of on-screen-display text */
+};
+
+/**
+   Options of pipeline stages (each stage takes those it needs.)
+*/
+struct StageOptions
+{
+    int device = 0;             /**< capture device index */
+    int width = 0;              /**< capture frame width */
+    int height = 0;             /**< capture frame height */
+    double duration = 0;        /**< seconds to capture for */
+    float max_fps = std::numeric_limits <float>::max();  /**< capture framerate limit */
+    std::string title;          /**< display window title */
+};
+
+/**
+   Stages fused into one, run in sequence on every frame, in a single
+   loop of a single thread: frames are passed from stage to stage with
+   no queue (nor buffer) in between.
+
+   A stage is any class constructible from StageOptions, with a
+   method *bool process(Frame& frame)* returning false at the end of
+   the stream.  A stage instance is only ever run by one thread, hence
+   stages may keep state from frame to frame.
+*/
+template <typename... Stages>
+class Fused;
+
+template <>
+class Fused <>
+{
+public:
+    explicit Fused(const StageOptions&) {/* Empty. */}
+    bool process(Frame&) { return true; }
+};
+
+template <typename First, typename... Rest>
+class Fused <First, Rest...>
+{
+public:
+    explicit Fused(const StageOptions& options) :
+        m_first (options),
+        m_rest  (options)
+        {/* Empty. */}
+
+    bool process(Frame& frame)
+    {
+        return m_first.process(frame) && m_rest.process(frame);
+    }
+
+private:
+    First m_first;
+    Fused <Rest...> m_rest;
+};
+
+/**
+   Segment of a pipeline, run by a thread of its own.
+*/
+class Segment
+{
+public:
+    virtual ~Segment() {/* Empty. */}
+    virtual bool process(Frame& frame) = 0;
+};
+
+/**
+   Segment running given stage (usually Fused.)
+*/
+template <typename Stage>
+class SegmentOf : public Segment
+{
+public:
+    explicit SegmentOf(const StageOptions& options) :
+        m_stage (options)
+        {/* Empty. */}
+
+    bool process(Frame& frame) { return m_stage.process(frame); }
+
+private:
+    Stage m_stage;
+};
+
+/**
+   Pipeline of segments, connected by edges (see Pipeline.)
+*/
+class PipelineBase
+{
+public:
+    /**
+       Run the pipeline to the end of the stream: every segment
+       but the last on a thread of its own, the last (e.g. the
+       display) on the calling thread.
+    */
+    void run();
+
+    /**
+       Return the edge into given segment (from the one before.)
+    */
+    Edge <Frame*>& getEdge(const int& segment) { return *m_edges[segment - 1]; }
+
+    /**
+       Print counters of the edges, frames and matrix pool.
+    */
+    void report(std::ostream& out);
+
+    /**
+       Return the policy blocking the producer
+       once given number of frames are queued.
+    */
+    static EdgePolicy blocking(const int& capacity);
+
+protected:
+    PipelineBase(
+        const std::vector <Segment*>& segments,
+        const EdgePolicy& policy);
+
+private:
+    /**
+       Run given segment, until the end of the stream.
+    */
+    void runSegment(const size_t& index);
+
+    /**
+       Return a recycled frame, or a new one if none are free.
+    */
+    Frame* acquire();
+
+    /**
+       Return given frame to the source.
+    */
+    void recycle(Frame* frame);
+
+    std::vector <std::unique_ptr <Segment>> m_segments;
+    std::vector <std::unique_ptr <Edge <Frame*>>> m_edges;
+    std::vector <std::unique_ptr <Frame>> m_frames;
+    bites::ConcurrentQueue <Frame*> m_free;
+    std::atomic <bool> m_stopping;
+};
+
+/**
+   Pipeline of stages, composed at compile time.  Each template
+   argument is a segment run by a thread of its own, and segments
+   are connected by edges of given overload policy; the first
+   segment's first stage is the source.  The thread split is hence
+   part of the type, e.g. capturing, processing and displaying all
+   in one loop, or each on a thread of its own:
+
+       Pipeline <Fused <Capture, DiffAverage, Display>> fused (options);
+       Pipeline <Capture, DiffAverage, Display> threaded (options);
+*/
+template <typename... Segments>
+class Pipeline : public PipelineBase
+{
+public:
+    explicit Pipeline(
+        const StageOptions& options,
+        const EdgePolicy& policy = blocking(2)) :
+        PipelineBase({ new SegmentOf <Segments> (options)... }, policy)
+        {/* Empty. */}
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_PIPELINE_HPP_INCLUDED
@@ -0,0 +1,76 @@
+#ifndef SHERLOCK_PLACEMENT_HPP_INCLUDED
+#define SHERLOCK_PLACEMENT_HPP_INCLUDED
+
+// Include standard headers.
+#include <string>
+#include <vector>
+
+namespace sherlock {
+
+/**
+   Placement of a pipeline thread: the CPUs it may run on, its
+   scheduling policy and priority (or niceness), and the NUMA node
+   its memory is allocated on.  Placements are applied by each
+   thread to itself, as it starts.
+*/
+struct Placement
+{
+    enum Policy
+    {
+        OTHER,   /**< default time-sharing (with *nice* value) */
+        FIFO,    /**< real-time, first in first out (with *priority*) */
+        RR,      /**< real-time, round robin (with *priority*) */
+    };
+    std::vector <int> cpus;   /**< allowed CPUs (all if empty) */
+    Policy policy = OTHER;
+    int priority = 0;         /**< FIFO and RR: real-time priority */
+    int nice = 0;             /**< OTHER: niceness */
+    bool has_nice = false;    /**< OTHER: whether to change niceness */
+    int node = -1;            /**< NUMA node for allocations (any if negative) */
+
+    /**
+       Return true if the placement changes nothing.
+    */
+    bool isDefault() const
+    {
+        return cpus.empty() && policy == OTHER && !has_nice && node < 0;
+    }
+};
+
+/**
+   Parse a placement specification, any of (in any order)
+      cpus LIST       e.g. "0-3,8"
+      node N          allocate on node N (and run on its CPUs,
+                      unless cpus are given)
+      fifo PRIORITY   real-time scheduling
+      rr PRIORITY     real-time round-robin scheduling
+      nice N          niceness of time-sharing scheduling
+   @return  False if the specification is not valid.
+*/
+bool parsePlacement(const std::string& spec, Placement& placement);
+
+/**
+   Apply the placement to the calling thread, and print the actual
+   placement it ends up with.  Failures (e.g. lacking privileges
+   for real-time scheduling) are reported, and the thread carries on.
+
+   @param  name       Name of the thread (for reporting.)
+   @param  placement  The placement.
+*/
+void applyPlacement(const std::string& name, const Placement& placement);
+
+/**
+   Describe the actual placement of the calling thread
+   (current CPU, allowed CPUs, scheduling and memory policy.)
+*/
+std::string describePlacement();
+
+/**
+   Return the NUMA node holding the memory at given address,
+   or -1 if unknown.
+*/
+int memoryNode(const void* address);
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_PLACEMENT_HPP_INCLUDED
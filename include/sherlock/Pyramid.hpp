@@ -0,0 +1,156 @@
+#ifndef SHERLOCK_PYRAMID_HPP_INCLUDED
+#define SHERLOCK_PYRAMID_HPP_INCLUDED
+
+// Include standard headers.
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Image pyramid of a frame, with integral images of every level.
+
+   Levels are scaled down from the grayscale frame by successive
+   powers of the scale factor, exactly as cv::CascadeClassifier does.
+   The frame itself may first be reduced to a lower resolution, in
+   which case the pyramid (and detections in it) is of the reduced
+   frame, as if that had been captured.
+   Scaled images and their integrals are computed on first use only,
+   and may be shared by any number of cascades (and threads)
+   evaluated on the same frame.
+*/
+class Pyramid
+{
+public:
+    /**
+       Initialize the pyramid of given frame.
+
+       @param  frame         The frame (grayscale or BGR.)
+       @param  scale_factor  Amount to reduce image at each level.
+       @param  resolution    Scale of the reduced frame (see reducedSize.)
+    */
+    Pyramid(
+        const cv::Mat& frame,
+        const double& scale_factor,
+        const double& resolution = 1);
+
+    /**
+       Return the size of given frame size reduced to given resolution.
+    */
+    static cv::Size reducedSize(const cv::Size& size, const double& resolution)
+    {
+        if (resolution >= 1)
+        {
+            return size;
+        }
+        return cv::Size(
+            std::max(1, cvRound(size.width * resolution)),
+            std::max(1, cvRound(size.height * resolution)));
+    }
+
+    double getScaleFactor() const { return m_scale_factor; }
+    cv::Size getFrameSize() const { return m_size; }
+    int getLevelCount() const { return m_levels.size(); }
+
+    /**
+       Return the scaling factor of given level
+       (the frame is larger than the level by this factor.)
+    */
+    double getFactor(const int& level) const { return m_levels[level]->factor; }
+
+    /**
+       Return the image size of given level.
+    */
+    cv::Size getSize(const int& level) const { return m_levels[level]->size; }
+
+    /**
+       Return the scaled grayscale image of given level.
+    */
+    const cv::Mat& getImage(const int& level);
+
+    /**
+       Return the integral image (CV_32S) of given level.
+    */
+    const cv::Mat& getSum(const int& level);
+
+    /**
+       Return the integral of squares image (CV_64F) of given level.
+    */
+    const cv::Mat& getSquaredSum(const int& level);
+
+    /**
+       Return the rotated integral image (CV_32S) of given level.
+    */
+    const cv::Mat& getTilted(const int& level);
+
+private:
+    // Disallow copying.
+    Pyramid(const Pyramid&);
+    Pyramid& operator=(const Pyramid&);
+
+    /**
+       A single level, computed piecewise on demand.
+    */
+    struct Level
+    {
+        double factor;
+        cv::Size size;
+        std::once_flag image_once;
+        std::once_flag sum_once;
+        std::once_flag tilted_once;
+        cv::Mat image;
+        cv::Mat sum;
+        cv::Mat sqsum;
+        cv::Mat tilted;
+    };
+
+    /**
+       Return the grayscale frame.
+    */
+    const cv::Mat& getGray();
+
+    const double m_scale_factor;
+    const cv::Mat m_frame;
+    const cv::Size m_size;
+    std::once_flag m_gray_once;
+    cv::Mat m_gray;
+    std::vector <std::unique_ptr <Level>> m_levels;
+};
+
+/**
+   Pyramids of frames in flight, shared by all classifiers.
+   A frame's pyramids must be released before the frame is deallocated.
+*/
+class PyramidCache
+{
+public:
+    /**
+       Return the pyramid of given frame, scale factor and
+       resolution, creating it if necessary.
+    */
+    std::shared_ptr <Pyramid> get(
+        const cv::Mat* frame,
+        const double& scale_factor,
+        const double& resolution = 1);
+
+    /**
+       Release all pyramids of given frame.
+    */
+    void release(const cv::Mat* frame);
+
+private:
+    typedef std::tuple <const cv::Mat*, double, double> Key;
+    std::mutex m_mutex;
+    std::map <Key, std::shared_ptr <Pyramid>> m_pyramids;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_PYRAMID_HPP_INCLUDED
@@ -0,0 +1,129 @@
+#ifndef SHERLOCK_RECORDING_HPP_INCLUDED
+#define SHERLOCK_RECORDING_HPP_INCLUDED
+
+// Include standard headers.
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Include 3rd party headers.
+#include <boost/date_time.hpp>
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Writer of a recording of a capture session.
+
+   The file holds a header (magic, format version and the capture
+   time of the first frame), followed by one record per frame:
+   its capture time offset (in microseconds), and the frame
+   losslessly encoded as PNG, so that replayed frames are
+   bit-identical to the captured ones.
+*/
+class RecordingWriter
+{
+public:
+    /**
+       Create the recording file.
+       @return  False if the file could not be created.
+    */
+    bool open(const std::string& fname);
+
+    /**
+       Append a frame captured at given time.
+    */
+    void write(const cv::Mat& frame, const boost::posix_time::ptime& tstamp);
+
+    /**
+       Return the number of frames written.
+    */
+    int getCount() const { return m_count; }
+
+private:
+    std::ofstream m_file;
+    boost::posix_time::ptime m_start;
+    int m_count = 0;
+};
+
+/**
+   Reader of a recording.
+*/
+class RecordingReader
+{
+public:
+    /**
+       Open the recording file.
+       @return  False if the file could not be opened (or is not a recording.)
+    */
+    bool open(const std::string& fname);
+
+    /**
+       Read the next frame and its capture time.
+       @return  False at the end of the recording.
+    */
+    bool read(cv::Mat& frame, boost::posix_time::ptime& tstamp);
+
+    /**
+       Read the next frame still encoded (see decode), and its capture
+       time, so that frames may be decoded on other threads.
+       @return  False at the end of the recording.
+    */
+    bool readEncoded(std::vector <uchar>& buffer, boost::posix_time::ptime& tstamp);
+
+    /**
+       Decode a frame read by readEncoded.
+       @return  False if the frame could not be decoded.
+    */
+    static bool decode(const std::vector <uchar>& buffer, cv::Mat& frame);
+
+private:
+    std::ifstream m_file;
+    boost::posix_time::ptime m_start;
+    std::vector <uchar> m_buffer;
+};
+
+/**
+   Reader of the frames of an MJPEG video (in any container, or none),
+   still encoded: every frame is a complete JPEG image, found in the
+   file by its markers, so that frames may be decoded on other threads.
+   Frames are timed at the video's framerate.
+*/
+class MjpegReader
+{
+public:
+    /**
+       Open the video file, timing frames from given start
+       at given framerate.
+       @return  False if the file could not be opened
+                (or the framerate is not positive.)
+    */
+    bool open(
+        const std::string& fname,
+        const boost::posix_time::ptime& start,
+        const double& fps);
+
+    /**
+       Read the next frame still encoded (see decode),
+       and its capture time.
+       @return  False at the end of the video.
+    */
+    bool readEncoded(std::vector <uchar>& buffer, boost::posix_time::ptime& tstamp);
+
+    /**
+       Decode a frame read by readEncoded (in color,
+       as the video would be decoded.)
+       @return  False if the frame could not be decoded.
+    */
+    static bool decode(const std::vector <uchar>& buffer, cv::Mat& frame);
+
+private:
+    std::ifstream m_file;
+    boost::posix_time::ptime m_start;
+    double m_interval;  // Microseconds per frame.
+    long m_count;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_RECORDING_HPP_INCLUDED
@@ -0,0 +1,116 @@
+#ifndef SHERLOCK_STAGES_HPP_INCLUDED
+#define SHERLOCK_STAGES_HPP_INCLUDED
+
+// Include standard headers.
+#include <string>
+
+// Include 3rd party headers.
+#include <boost/date_time.hpp>
+#include <opencv2/opencv.hpp>
+#include <bites.hpp>
+
+// Include application headers.
+#include "Pacer.hpp"
+#include "Pipeline.hpp"
+
+namespace sherlock {
+
+/**
+   Source stage, capturing frames from a device for the given
+   duration, observing the maximum framerate.  Sets the alpha value
+   of every frame from the time since the previous capture.
+*/
+class Capture
+{
+public:
+    explicit Capture(const StageOptions& options);
+    bool process(Frame& frame);
+
+private:
+    cv::VideoCapture m_cap;
+    const double m_duration;
+    Pacer m_pacer;
+    Pacer::Clock::time_point m_end;
+    bool m_started;
+    boost::posix_time::ptime m_tstamp_prev;
+};
+
+/**
+   Stage replacing frames with their difference
+   from the running average of frames.
+*/
+class DiffAverage
+{
+public:
+    explicit DiffAverage(const StageOptions&);
+    bool process(Frame& frame);
+
+private:
+    cv::Mat m_average;
+    cv::Mat m_converted;
+    cv::Mat m_diff;
+};
+
+/**
+   Stage adding its framerates to the on-screen-display text.
+*/
+class RateOSD
+{
+public:
+    explicit RateOSD(const std::string& label) :
+        m_label  (label),
+        m_ticker ({ 1, 5, 10 })
+        {/* Empty. */}
+
+    bool process(Frame& frame);
+
+private:
+    const std::string m_label;
+    bites::RateTicker m_ticker;
+};
+
+/**
+   Framerates measured by a Rate stage.
+*/
+enum RateKind
+{
+    CAPTURE_RATE,
+    PROCESSING_RATE,
+    DISPLAY_RATE,
+};
+
+/**
+   Stage adding framerates of given kind to the on-screen-display text.
+*/
+template <RateKind KIND>
+class Rate : public RateOSD
+{
+public:
+    explicit Rate(const StageOptions&) :
+        RateOSD (KIND == CAPTURE_RATE ? "capture" :
+                 KIND == PROCESSING_RATE ? "processing" : "display")
+        {/* Empty. */}
+};
+
+/**
+   Sink stage, writing the on-screen-display text
+   onto frames, and displaying them in a window.
+*/
+class Display
+{
+public:
+    explicit Display(const StageOptions& options) :
+        m_title   (options.title),
+        m_created (false)
+        {/* Empty. */}
+
+    bool process(Frame& frame);
+
+private:
+    const std::string m_title;
+    bool m_created;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_STAGES_HPP_INCLUDED
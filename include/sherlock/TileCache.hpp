@@ -0,0 +1,150 @@
+#ifndef SHERLOCK_TILECACHE_HPP_INCLUDED
+#define SHERLOCK_TILECACHE_HPP_INCLUDED
+
+// Include standard headers.
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Include 3rd party headers.
+#include <opencv2/opencv.hpp>
+
+namespace sherlock {
+
+/**
+   Cache of detection results of a cascade over a grid of tiles, for
+   cameras seeing a mostly static scene.
+
+   Every tile has a signature (a thumbnail of the tile) compared with
+   the signature of the tile when last scanned: only windows touching
+   tiles that changed beyond a threshold (and a rotating subset of
+   tiles, refreshed regardless) are scanned again; candidate windows
+   (positive ones included) lying entirely in unchanged tiles are
+   carried over from the previous scan.
+
+   A cache is used by a single evaluator (not thread-safe), except
+   for its statistics.
+*/
+class TileCache
+{
+public:
+    /**
+       Tiling of the frame (no caching if without tiles.)
+    */
+    struct Parameters
+    {
+        int columns;      /**< number of tile columns (0: no caching) */
+        int rows;         /**< number of tile rows */
+        float threshold;  /**< mean absolute difference (in gray levels) of a
+                               tile's signature for the tile to be scanned */
+        int refresh;      /**< number of tiles scanned regardless, per frame */
+    };
+
+    /**
+       Statistics of the cache.
+    */
+    struct Stats
+    {
+        long frames;   /**< number of frames */
+        long tiles;    /**< number of tiles in all frames */
+        long scanned;  /**< number of tiles scanned */
+    };
+
+    TileCache();
+
+    /**
+       Set the tiling (resetting the cache, if changed.)
+    */
+    void setParameters(const Parameters& params);
+
+    /**
+       Start over with the next image.
+    */
+    void reset() { m_valid = false; }
+
+    /**
+       Return true if caching.
+    */
+    bool isEnabled() const { return m_params.columns > 0 && m_params.rows > 0; }
+
+    /**
+       Compare the tile signatures of given (grayscale) image with
+       those of the previous scan, marking the tiles to be scanned.
+       The cache is reset as the image size or the scan (given by
+       *scan*, e.g. scale factor and size limits) differs from the
+       previous one's.
+    */
+    void update(const cv::Mat& gray, const std::vector <double>& scan);
+
+    /**
+       Return true if given window (in image coordinates) touches
+       a tile to be scanned, i.e. if the window is to be scanned.
+    */
+    bool isScanned(const cv::Rect& window) const
+    {
+        return !isEnabled() || count(window) > 0;
+    }
+
+    /**
+       Return true if any window in given rows touches a tile to
+       be scanned (for skipping rows of windows altogether.)
+    */
+    bool isScanned(const int& top, const int& bottom) const
+    {
+        return !isEnabled() || count(cv::Rect(0, top, m_size.width, bottom - top)) > 0;
+    }
+
+    /**
+       Add the candidates of the previous scan lying in tiles not
+       scanned to *candidates* (those of the windows scanned), and
+       keep the whole as the candidates of the scan.
+    */
+    void merge(std::vector <cv::Rect>& candidates);
+
+    /**
+       Retrieve the statistics (from any thread.)
+    */
+    Stats getStats() const;
+
+private:
+    // Size of the signature of a tile (in pixels per side.)
+    static const int SIGNATURE = 8;
+
+    /**
+       Return the number of tiles to be scanned that
+       given rectangle (in image coordinates) touches.
+    */
+    int count(const cv::Rect& rect) const
+    {
+        int x0 = std::max(0, rect.x) / m_tile.width;
+        int y0 = std::max(0, rect.y) / m_tile.height;
+        int x1 = std::min(m_grid.width, (rect.x + rect.width - 1) / m_tile.width + 1);
+        int y1 = std::min(m_grid.height, (rect.y + rect.height - 1) / m_tile.height + 1);
+        if (x0 >= x1 || y0 >= y1)
+        {
+            return 0;
+        }
+        return m_counts.at<int>(y1, x1) - m_counts.at<int>(y0, x1)
+            - m_counts.at<int>(y1, x0) + m_counts.at<int>(y0, x0);
+    }
+
+    Parameters m_params;
+    cv::Size m_size;
+    std::vector <double> m_scan;
+    cv::Size m_grid;
+    cv::Size m_tile;
+    cv::Mat m_thumbnails;  // Signatures of the current image.
+    cv::Mat m_signatures;  // Signatures of tiles when last scanned.
+    cv::Mat m_scanned;
+    cv::Mat m_counts;      // Integral of m_scanned.
+    int m_next_refresh;
+    bool m_valid;
+    std::vector <cv::Rect> m_candidates;
+    std::atomic <long> m_frames;
+    std::atomic <long> m_tiles;
+    std::atomic <long> m_scanned_tiles;
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_TILECACHE_HPP_INCLUDED
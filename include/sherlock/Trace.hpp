@@ -0,0 +1,110 @@
+#ifndef SHERLOCK_TRACE_HPP_INCLUDED
+#define SHERLOCK_TRACE_HPP_INCLUDED
+
+// Include standard headers.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace sherlock {
+
+/**
+   Span tracing of the pipeline, exported as Chrome trace JSON (for
+   chrome://tracing or Perfetto), so that the time every frame spent
+   in every stage can be followed.  Spans are recorded by the thread
+   running them into a ring buffer of its own (without locking), the
+   latest 16384 spans of every thread being kept.
+
+   Tracing is compiled in by defining SHERLOCK_TRACE (scons trace=1);
+   otherwise spans are empty, and compile to nothing.
+*/
+class Trace
+{
+public:
+    /**
+       Name the calling thread in the trace.
+    */
+    static void setThreadName(const std::string& name);
+
+    /**
+       Return a copy of given name lasting for the whole run
+       (for naming spans after objects that may be destroyed.)
+    */
+    static const char* intern(const std::string& name);
+
+    /**
+       Write the spans recorded as Chrome trace JSON, every span
+       tagged with the sequence number of its frame.
+       @return  The number of spans written.
+    */
+    static long write(std::ostream& out);
+
+    /**
+       Write the trace into given file.
+       @return  False if the file could not be written.
+    */
+    static bool save(const std::string& fname);
+
+    /**
+       Return true if tracing is compiled in.
+    */
+    static bool isEnabled();
+};
+
+#ifdef SHERLOCK_TRACE
+
+/**
+   A span of time traced, from construction to destruction,
+   optionally of a frame (the frame's first span numbering it.)
+*/
+class Span
+{
+public:
+    explicit Span(const char* name) :
+        m_name  (name),
+        m_frame (NULL),
+        m_first (false),
+        m_begin (std::chrono::steady_clock::now())
+        {/* Empty. */}
+
+    ~Span();
+
+    /**
+       Set the frame of the span.
+    */
+    void setFrame(const void* frame) { m_frame = frame; }
+
+    /**
+       Set the frame of the span, the first of the frame
+       (which numbers frames in the trace.)
+    */
+    void startFrame(const void* frame) { m_frame = frame; m_first = true; }
+
+private:
+    const char* m_name;
+    const void* m_frame;
+    bool m_first;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+#else
+
+class Span
+{
+public:
+    explicit Span(const char*) {/* Empty. */}
+    void setFrame(const void*) {/* Empty. */}
+    void startFrame(const void*) {/* Empty. */}
+};
+
+inline void Trace::setThreadName(const std::string&) {/* Empty. */}
+inline const char* Trace::intern(const std::string&) { return ""; }
+inline bool Trace::isEnabled() { return false; }
+
+#endif  // SHERLOCK_TRACE
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_TRACE_HPP_INCLUDED
@@ -0,0 +1,51 @@
+#ifndef SHERLOCK_WATCHER_HPP_INCLUDED
+#define SHERLOCK_WATCHER_HPP_INCLUDED
+
+// Include standard headers.
+#include <functional>
+#include <string>
+
+// Include 3rd party headers.
+#include <bites.hpp>
+
+namespace sherlock {
+
+/**
+   File watching thread.
+   Invokes a callback whenever the watched file is written,
+   or replaced (as editors commonly do when saving.)
+*/
+class Watcher : public bites::Thread
+{
+public:
+    /**
+       Initialize the watcher.
+
+       @param  fname      Name of file to watch.
+       @param  on_change  Callback invoked (on the watcher thread)
+                          after the file has changed.
+    */
+    Watcher(
+        const std::string& fname,
+        std::function <void (void)> on_change
+        );
+    ~Watcher();
+
+    /**
+       Signal the watcher thread to stop.
+    */
+    void stop();
+
+private:
+    std::string m_fname;
+    std::function <void (void)> m_on_change;
+
+    // Event descriptor used to wake up the thread for stopping.
+    int m_stop_fd;
+
+    void run();
+};
+
+}  // namespace sherlock.
+
+#endif  // SHERLOCK_WATCHER_HPP_INCLUDED
@@ -0,0 +1,69 @@
+#ifndef SHERLOCK_CONFIG_HPP_INCLUDED
+#define SHERLOCK_CONFIG_HPP_INCLUDED
+
+/**
+  Classifier configuration file reading.
+*/
+#include <string>
+#include <vector>
+
+#include "Classifier.hpp"
+#include "Edge.hpp"
+#include "Fuser.hpp"
+#include "Graph.hpp"
+#include "Placement.hpp"
+
+namespace sherlock {
+
+/**
+  A classifier listed in the classifier configuration file,
+  resolved to one of its XML files.
+*/
+struct ClassifierEntry
+{
+    std::string fname;               /**< full name of XML file */
+    Classifier::Parameters params;   /**< detection parameters */
+    EdgePolicy policy;               /**< overload policy of input queue */
+};
+
+/**
+  Settings of the classifier configuration file
+  (other than the detection parameters.)
+*/
+struct ClassifierSettings
+{
+    std::string cache_dir;          /**< directory of compiled cascade cache */
+    bool batch;                     /**< evaluate classifiers in a single batch */
+    EdgePolicy display_policy;      /**< overload policy of display queue */
+    int display_width;              /**< maximum width of displayed frames */
+    EdgePolicy classifier_policy;   /**< default overload policy of classifier
+                                         (or batch) input queues */
+    bool fusion;                    /**< fuse detections of all classifiers */
+    Fuser::Parameters fusion_params;  /**< parameters of the fusion */
+    Placement capture_placement;      /**< placement of capture thread */
+    Placement classifier_placement;   /**< placement of classifier (or batch) threads */
+    Placement display_placement;      /**< placement of display, fusion
+                                           and deallocator threads */
+    Graph graph;                      /**< processing graph (which the
+                                           settings above follow) */
+};
+
+/**
+  Read the classifier configuration file.
+  Every classifier is resolved against each of the DIRS directories,
+  resulting in one entry per XML file found.
+
+  @param  config_fname  Name of configuration file.
+  @param  settings      Output settings.
+  @param  source        Name of the source (e.g. the video device
+                        number), selecting its exclusion mask.
+  @return  The classifier entries.
+*/
+std::vector <ClassifierEntry> readClassifierConfig(
+    const std::string& config_fname,
+    ClassifierSettings& settings,
+    const std::string& source = "");
+
+} // namespace sherlock.
+
+#endif  // SHERLOCK_CONFIG_HPP_INCLUDED
@@ -6,9 +6,12 @@
 */
 #include <list>
 #include <string>
+#include <vector>
 #include <boost/date_time.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "Clock.hpp"
+
 namespace sherlock {
 
 /**
@@ -26,10 +29,23 @@ namespace sherlock {
 
   @param  tstamp_prev  The previous timestamp with which to compute alpha.
   @param  max_life     Ceiling duration value.
+  @param  clock        Clock telling the time now.
 */
 double getAlpha(
     boost::posix_time::ptime& tstamp_prev,
-    double max_life);
+    double max_life,
+    Clock& clock = Clock::system());
+
+/**
+  Scale rectangles (positions and sizes) by given factor,
+  e.g. to map detections in a reduced image back to the frame.
+
+  @param  rects   The rectangles.
+  @param  factor  Scaling factor.
+*/
+void scaleRects(
+    std::vector<cv::Rect>& rects,
+    const double& factor);
 
 /**
   Write text given in *lines* iterable,
@@ -0,0 +1,123 @@
+/**
+   The Batch class implements batched evaluation of classifiers.
+*/
+
+// Include standard headers.
+#include <map>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+void Batch::addMember(Classifier* classifier)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_members.emplace_back(classifier);
+}
+
+
+void Batch::removeMember(Classifier* classifier)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_members.remove_if([classifier](const Member& member) {
+        return member.classifier == classifier; });
+}
+
+
+void Batch::detect(const cv::Mat* frame, const float& scale)
+{
+    Span span ("batch detect");
+    span.setFrame(frame);
+    std::lock_guard <std::mutex> locker (m_mutex);
+
+    // Members batched together, by scale factor and resolution
+    // (at reduced resolution, batches sweep a scaled-down copy
+    // of the frame.)
+    struct Batched
+    {
+        Member* member;
+        Classifier::Parameters params;
+    };
+    std::map <std::pair <float, float>, std::vector <Batched>> batches;
+
+    std::vector<cv::Rect> rects;
+    for(auto& member : m_members)
+    {
+        if(!member.classifier->isReady() || member.classifier->isPaused())
+        {
+            continue;
+        }
+        auto params = member.classifier->getParameters();
+        if(member.classifier->useNative(params))
+        {
+            float resolution = scale*member.classifier->getResolution(params, frame->size());
+            batches[{ params.scale_factor, resolution }].push_back({ &member, params });
+            continue;
+        }
+
+        // Classifiers not using the native engine run on their own.
+        member.classifier->detect(frame, params, rects, scale);
+        member.classifier->publish(frame, rects);
+    }
+
+    // Sweep the frame's shared pyramid once per batch.
+    for(auto& batch : batches)
+    {
+        cv::Size size = Pyramid::reducedSize(frame->size(), batch.first.second);
+        std::vector <Evaluator*> evaluators;
+        std::vector <Evaluator::Limits> limits;
+        for(auto& batched : batch.second)
+        {
+            auto& params = batched.params;
+            batched.member->evaluator->setTiles(params.tiles);
+            batched.member->evaluator->setExclusion(params.exclusion);
+            evaluators.push_back(batched.member->evaluator.get());
+            limits.push_back({
+                params.min_neighbors,
+                cv::Size(
+                    size.width*params.min_size_ratio,
+                    size.height*params.min_size_ratio),
+                cv::Size(
+                    size.width*params.max_size_ratio,
+                    size.height*params.max_size_ratio),
+                });
+        }
+        std::vector <std::vector <cv::Rect>> objects;
+        auto pyramid = m_pyramids.get(frame, batch.first.first, batch.first.second);
+        Evaluator::detectBatch(*pyramid, evaluators, limits, objects);
+        for(size_t ii = 0; ii < objects.size(); ++ii)
+        {
+            auto& batched = batch.second[ii];
+            if(size != frame->size())
+            {
+                scaleRects(objects[ii], (double)frame->cols / size.width);
+            }
+            batched.member->classifier->publish(frame, objects[ii]);
+        }
+    }
+}
+
+
+void Batch::run ()
+{
+    applyPlacement("batch", m_placement);
+    Trace::setThreadName("batch");
+    PerfCounters::attach("batch");
+    MatPool::setStage("classifier");
+
+    // Pull from the queue while there are valid matrices
+    // (excess frames are dropped by the input queue's overload policy.)
+    cv::Mat* frame;
+    float scale;
+    m_input_queue.wait_and_pop(frame, scale);
+    while(frame)
+    {
+        detect(frame, scale);
+        PerfCounters::frameDone();
+        m_done_queue.push(frame);
+        m_input_queue.wait_and_pop(frame, scale);
+    }
+}
+
+}  // namespace sherlock.
@@ -1,3 +1,6 @@
+// Include standard headers.
+#include <algorithm>
+
 // Include 3rd party headers.
 #include <bites.hpp>
 
@@ -6,28 +9,176 @@
 
 namespace sherlock {
 
-void Captor::addOutput( bites::ConcurrentQueue <cv::Mat*>& output )
+void Captor::addOutput( Edge <cv::Mat*>& output )
 {
     std::lock_guard <std::mutex> locker (m_output_queues_mutex);
     m_output_queues.push_back( &output );
 }
 
+void Captor::removeOutput( Edge <cv::Mat*>& output )
+{
+    std::lock_guard <std::mutex> locker (m_output_queues_mutex);
+    m_output_queues.erase(
+        std::remove(m_output_queues.begin(), m_output_queues.end(), &output),
+        m_output_queues.end());
+}
+
+void Captor::setFanoutCallback( std::function <void (cv::Mat*, int)> callback )
+{
+    std::lock_guard <std::mutex> locker (m_output_queues_mutex);
+    m_fanout_callback = callback;
+}
+
 void Captor::pushOutput( cv::Mat* frame ) 
 {
     std::lock_guard <std::mutex> locker (m_output_queues_mutex);
+    if (frame && m_fanout_callback)
+    {
+        m_fanout_callback (frame, m_output_queues.size());
+    }
     for (auto oqueue : m_output_queues)
     {
         oqueue->push (frame);
     }
 }
 
+void Captor::endOutput()
+{
+    if (m_stopping)
+    {
+        std::lock_guard <std::mutex> locker (m_output_queues_mutex);
+        for (auto oqueue : m_output_queues)
+        {
+            oqueue->discard();
+        }
+    }
+    pushOutput( NULL );
+}
+
 std::vector <float> Captor::getFramerate ()
 {
     return m_framerate.get();
 }
 
+void Captor::setReplay( const std::string& fname, const bool& realtime, const int& decoders )
+{
+    m_replay_fname = fname;
+    m_realtime = realtime;
+    m_decoder.reset(new Decoder(decoders));
+}
+
+Decoder::Stats Captor::getDecodeStats ()
+{
+    if (!m_decoder)
+    {
+        return { 0, 0, 0 };
+    }
+    return m_decoder->getStats();
+}
+
+Clock& Captor::getClock ()
+{
+    if (isReplaying())
+    {
+        return m_replay_clock;
+    }
+    return Clock::system();
+}
+
+void Captor::frameDone( cv::Mat* frame )
+{
+    if (isReplaying())
+    {
+        m_released.push(frame);
+    }
+}
+
+void Captor::replay ()
+{
+    if (!m_decoder->open(m_replay_fname))
+    {
+        std::cout << "Warning: Failed to open recording "
+                  << m_replay_fname << std::endl;
+        endOutput();
+        return;
+    }
+
+    // Monitor framerates for the given seconds past.
+    bites::RateTicker ticker ({ 1, 5, 10 });
+
+    auto start = Pacer::now();
+    boost::posix_time::ptime first;
+    int count = 0;
+    while (!m_stopping)
+    {
+        // Take the next frame (decoded ahead, from the matrix pool.)
+        cv::Mat* frame = NULL;
+        boost::posix_time::ptime tstamp;
+        {
+            Span span ("decode wait");
+            if (m_decoder->read(frame, tstamp))
+            {
+                span.setFrame(frame);
+            }
+        }
+        if (!frame)
+        {
+            break;
+        }
+        if (count == 0)
+        {
+            first = tstamp;
+        }
+        if (m_duration > 0 && tstamp - first > boost::posix_time::seconds(m_duration))
+        {
+            delete frame;
+            break;
+        }
+
+        // In real time, wait for the frame's time to come
+        // (unless stopped meanwhile.)
+        if (m_realtime && !Pacer::sleepUntil(
+                start + std::chrono::microseconds((tstamp - first).total_microseconds()),
+                &m_stopping))
+        {
+            delete frame;
+            break;
+        }
+        m_replay_clock.set(tstamp);
+
+        // Set the framerate.
+        m_framerate.set(ticker.tick());
+
+        // Push the frame, and wait for it to be released.
+        pushOutput( frame );
+        PerfCounters::frameDone();
+        cv::Mat* released;
+        m_released.wait_and_pop(released);
+        ++count;
+    }
+
+    auto seconds = std::chrono::duration <double> (Pacer::now() - start).count();
+    std::cout << "Replayed " << count << " frames in " << seconds << " seconds ("
+              << (seconds > 0 ? count / seconds : 0) << " FPS)" << std::endl;
+    m_decoder->report(std::cout);
+
+    // Signal end-of-processing by pushing NULL onto all output queues.
+    endOutput();
+}
+
 void Captor::run ()
 {
+    applyPlacement("capture", m_placement);
+    Trace::setThreadName("capture");
+    PerfCounters::attach("capture");
+    MatPool::setStage("capture");
+
+    if (isReplaying())
+    {
+        replay();
+        return;
+    }
+
     // Create the OpenCV video capture object.
     cv::VideoCapture cap(m_device);
     cap.set(3, m_width);
@@ -36,41 +187,66 @@ void Captor::run ()
     // Monitor framerates for the given seconds past.
     bites::RateTicker ticker ({ 1, 5, 10 });
 
-    // Compute interval needed to observe maximum FPS limit.
-    float interval_float = 1 / m_max_fps;
-    int interval_sec = (int) interval_float;
-    auto min_interval = boost::posix_time::time_duration(
-        0, // Hours.
-        0, // Minutes.
-        interval_sec, // Seconds.
-        (interval_float - interval_sec) * 1000000  // Fractional seconds.
-        );
-
-    // Run the loop for designated amount of time.
-    auto prev = boost::posix_time::microsec_clock::universal_time();
-    auto end = prev + boost::posix_time::seconds(m_duration);
-    while (end > boost::posix_time::microsec_clock::universal_time())
+    // Record the session, if so configured.
+    RecordingWriter recorder;
+    bool recording = !m_record_fname.empty() && recorder.open(m_record_fname);
+    if (!m_record_fname.empty() && !recording)
+    {
+        std::cout << "Warning: Failed to create recording "
+                  << m_record_fname << std::endl;
+    }
+
+    // Run the loop for designated amount of time
+    // (on the monotonic clock, immune to clock adjustments),
+    // or until stopped.
+    auto& clock = getClock();
+    auto end = Pacer::now() + std::chrono::seconds(m_duration);
+    bool node_reported = false;
+    while (!m_stopping && (m_duration <= 0 || end > Pacer::now()))
     {
-        // Insert delay to observe maximum framerate limit.
-        auto elapsed = boost::posix_time::microsec_clock::universal_time() - prev;
-        auto sleep_microsec = ( min_interval - elapsed ).total_microseconds();
-	sleep_microsec = sleep_microsec < 0 ? 0 : sleep_microsec;
-        usleep(sleep_microsec);
-        prev = boost::posix_time::microsec_clock::universal_time();
+        // Wait for the frame's deadline, to observe maximum framerate limit
+        // (unless stopped meanwhile.)
+        if (!m_pacer.wait(&m_stopping))
+        {
+            break;
+        }
 
         // Take a snapshot.
         auto frame = new cv::Mat;
-        cap >> *frame; 
+        MatPool::attach(*frame);
+        {
+            Span span ("grab");
+            span.startFrame(frame);
+            cap >> *frame;
+        }
+        if (m_placement.node >= 0 && !node_reported && !frame->empty())
+        {
+            std::cout << "Capture frames on node " << memoryNode(frame->data)
+                      << " (placed on node " << m_placement.node << ")" << std::endl;
+            node_reported = true;
+        }
+        if (recording && !frame->empty())
+        {
+            recorder.write(*frame, clock.now());
+        }
 
         // Set the framerate.
         m_framerate.set(ticker.tick());
 
         // Push image onto all output queues.
         pushOutput( frame );
+        PerfCounters::frameDone();
+    }
+
+    m_pacer.report(std::cout);
+    if (recording)
+    {
+        std::cout << "Recorded " << recorder.getCount() << " frames to "
+                  << m_record_fname << std::endl;
     }
 
     // Signal end-of-processing by pushing NULL onto all output queues.
-    pushOutput( NULL );
+    endOutput();
 }
 
 }  // namespace sherlock.
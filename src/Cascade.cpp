@@ -0,0 +1,772 @@
+/**
+   The Cascade class compiles and caches cascade classifier data.
+*/
+
+// Include standard headers.
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+// Include system headers.
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Include 3rd party headers.
+#include <boost/filesystem.hpp>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+/**
+   Header of the compiled image.  It is followed by the arrays,
+   each aligned on a 16-byte boundary, in the order of the
+   array enumeration below.
+*/
+struct Cascade::Header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t feature_type;
+    uint64_t source_hash;
+    uint64_t size;
+    int32_t  window_width;
+    int32_t  window_height;
+    int32_t  stage_count;
+    int32_t  tree_count;
+    int32_t  node_count;
+    int32_t  leaf_count;
+    int32_t  feature_count;
+    int32_t  subset_size;
+    int32_t  has_tilted;
+    int32_t  is_stump;
+};
+
+namespace {
+
+const char MAGIC[8] = { 'S', 'H', 'R', 'L', 'C', 'A', 'S', 'C' };
+const uint32_t FORMAT_VERSION = 1;
+
+// Number of words of a node's subset of (8-bit) LBP codes.
+const int LBP_SUBSET_SIZE = 256 / 32;
+
+// Amount by which stage thresholds are lowered (same as OpenCV.)
+const float THRESHOLD_EPS = 1e-5f;
+
+// The arrays of the compiled image, in order.
+enum {
+    STAGE_FIRST_TREE, STAGE_TREE_COUNT, STAGE_THRESHOLD,
+    TREE_FIRST_NODE, TREE_FIRST_LEAF,
+    NODE_FEATURE, NODE_THRESHOLD, NODE_LEFT, NODE_RIGHT, NODE_SUBSET,
+    LEAF_VALUE,
+    FEATURE_RECTS, FEATURE_WEIGHTS, FEATURE_TILTED,
+    ARRAY_COUNT
+};
+
+// Byte offsets of arrays within the compiled image,
+// and the total size of the image.
+struct Layout
+{
+    size_t offsets[ARRAY_COUNT];
+    size_t lengths[ARRAY_COUNT];
+    size_t size;
+};
+
+// Compute the image layout for given element counts.
+// All array elements are 4 bytes wide.
+Layout computeLayout(
+    const size_t& header_size,
+    const size_t& stages,
+    const size_t& trees,
+    const size_t& nodes,
+    const size_t& leaves,
+    const size_t& features,
+    const size_t& subset_size)
+{
+    const size_t counts[ARRAY_COUNT] = {
+        stages, stages, stages,
+        trees, trees,
+        nodes, nodes, nodes, nodes, nodes * subset_size,
+        leaves,
+        features * 12, features * 3, features,
+    };
+    Layout layout;
+    size_t offset = header_size;
+    for (int ii = 0; ii < ARRAY_COUNT; ++ii)
+    {
+        offset = (offset + 15) & ~size_t(15);
+        layout.offsets[ii] = offset;
+        layout.lengths[ii] = counts[ii] * 4;
+        offset += layout.lengths[ii];
+    }
+    layout.size = offset;
+    return layout;
+}
+
+// 64-bit FNV-1a hash of given bytes.
+uint64_t hashBytes(const std::string& bytes)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto byte : bytes)
+    {
+        hash ^= static_cast <unsigned char> (byte);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Read entire file into given string.
+bool readBytes(const std::string& fname, std::string& bytes)
+{
+    std::ifstream file (fname.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    bytes.assign(
+        std::istreambuf_iterator <char> (file),
+        std::istreambuf_iterator <char> ());
+    return !file.bad();
+}
+
+// Return integer value of given node, or *value* if node is absent.
+int intOr(const cv::FileNode& node, const int& value)
+{
+    return node.empty() ? value : (int)node;
+}
+
+/**
+   Intermediate (growable) form of the compiled image,
+   filled in by the XML readers.
+*/
+struct Source
+{
+    int feature_type = Cascade::HAAR;
+    int width = 0;
+    int height = 0;
+    int subset_size = 0;
+    std::vector <int32_t> stage_first_tree;
+    std::vector <int32_t> stage_tree_count;
+    std::vector <float> stage_threshold;
+    std::vector <int32_t> tree_first_node;
+    std::vector <int32_t> tree_first_leaf;
+    std::vector <int32_t> node_feature;
+    std::vector <float> node_threshold;
+    std::vector <int32_t> node_left;
+    std::vector <int32_t> node_right;
+    std::vector <int32_t> node_subset;
+    std::vector <float> leaf_value;
+    std::vector <int32_t> feature_rects;
+    std::vector <float> feature_weights;
+    std::vector <int32_t> feature_tilted;
+
+    // Begin a new tree (in the current stage.)
+    void beginTree()
+    {
+        tree_first_node.push_back(node_feature.size());
+        tree_first_leaf.push_back(leaf_value.size());
+    }
+
+    // Append a Haar feature rectangle to the last feature.
+    bool addHaarRect(const cv::FileNode& rect, const int& slot)
+    {
+        if (slot >= 3 || rect.size() != 5)
+        {
+            return false;
+        }
+        const size_t base = feature_rects.size() - 12;
+        auto ii = rect.begin();
+        for (int jj = 0; jj < 4; ++jj, ++ii)
+        {
+            feature_rects[base + slot*4 + jj] = (int)*ii;
+        }
+        feature_weights[feature_weights.size() - 3 + slot] = (float)*ii;
+        return true;
+    }
+
+    // Append an empty feature.
+    void beginFeature(const int& tilted)
+    {
+        feature_rects.resize(feature_rects.size() + 12, 0);
+        feature_weights.resize(feature_weights.size() + 3, 0.f);
+        feature_tilted.push_back(tilted);
+    }
+};
+
+// Read cascade in the current (training tool) format.
+bool readCurrent(const cv::FileNode& root, Source& src)
+{
+    if ((std::string)root["stageType"] != "BOOST")
+    {
+        return false;
+    }
+    std::string feature_type = root["featureType"];
+    if (feature_type == "HAAR")
+    {
+        src.feature_type = Cascade::HAAR;
+    }
+    else if (feature_type == "LBP")
+    {
+        src.feature_type = Cascade::LBP;
+    }
+    else
+    {
+        return false;
+    }
+    src.width = (int)root["width"];
+    src.height = (int)root["height"];
+    int max_cat_count = intOr(root["featureParams"]["maxCatCount"], 0);
+    src.subset_size = max_cat_count > 0 ? (max_cat_count + 31) / 32 : 0;
+    if ((src.feature_type == Cascade::LBP) != (src.subset_size > 0))
+    {
+        return false;
+    }
+
+    // Each internal node is (left, right, feature, threshold),
+    // or (left, right, feature, subset...) for categorical features.
+    const size_t node_step = 3 + (src.subset_size > 0 ? src.subset_size : 1);
+    cv::FileNode stages = root["stages"];
+    if (stages.empty())
+    {
+        return false;
+    }
+    for (auto si = stages.begin(); si != stages.end(); ++si)
+    {
+        cv::FileNode stage = *si;
+        cv::FileNode weaks = stage["weakClassifiers"];
+        src.stage_first_tree.push_back(src.tree_first_node.size());
+        src.stage_threshold.push_back(
+            (float)stage["stageThreshold"] - THRESHOLD_EPS);
+        src.stage_tree_count.push_back(weaks.size());
+        for (auto wi = weaks.begin(); wi != weaks.end(); ++wi)
+        {
+            cv::FileNode internal = (*wi)["internalNodes"];
+            cv::FileNode leaves = (*wi)["leafValues"];
+            if (internal.empty() || leaves.empty() || internal.size() % node_step)
+            {
+                return false;
+            }
+            src.beginTree();
+            for (auto ni = internal.begin(); ni != internal.end(); )
+            {
+                src.node_left.push_back((int)*ni); ++ni;
+                src.node_right.push_back((int)*ni); ++ni;
+                src.node_feature.push_back((int)*ni); ++ni;
+                if (src.subset_size > 0)
+                {
+                    for (int jj = 0; jj < src.subset_size; ++jj, ++ni)
+                    {
+                        src.node_subset.push_back((int)*ni);
+                    }
+                    src.node_threshold.push_back(0.f);
+                }
+                else
+                {
+                    src.node_threshold.push_back((float)*ni); ++ni;
+                }
+            }
+            for (auto li = leaves.begin(); li != leaves.end(); ++li)
+            {
+                src.leaf_value.push_back((float)*li);
+            }
+        }
+    }
+
+    // Read the features.
+    cv::FileNode features = root["features"];
+    for (auto fi = features.begin(); fi != features.end(); ++fi)
+    {
+        if (src.feature_type == Cascade::HAAR)
+        {
+            src.beginFeature(intOr((*fi)["tilted"], 0));
+            cv::FileNode rects = (*fi)["rects"];
+            int slot = 0;
+            for (auto ri = rects.begin(); ri != rects.end(); ++ri, ++slot)
+            {
+                if (!src.addHaarRect(*ri, slot))
+                {
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            cv::FileNode rect = (*fi)["rect"];
+            if (rect.size() != 4)
+            {
+                return false;
+            }
+            src.beginFeature(0);
+            const size_t base = src.feature_rects.size() - 12;
+            auto ri = rect.begin();
+            for (int jj = 0; jj < 4; ++jj, ++ri)
+            {
+                src.feature_rects[base + jj] = (int)*ri;
+            }
+        }
+    }
+    return true;
+}
+
+// Read cascade in the legacy (haartraining) format,
+// converting every tree node into a node with its own feature.
+// Tree-structured cascades (with stage branching) are not supported.
+bool readLegacy(const cv::FileNode& root, Source& src)
+{
+    cv::FileNode size = root["size"];
+    cv::FileNode stages = root["stages"];
+    if (size.size() != 2 || stages.empty())
+    {
+        return false;
+    }
+    src.feature_type = Cascade::HAAR;
+    src.width = (int)size[0];
+    src.height = (int)size[1];
+
+    int stage_index = 0;
+    for (auto si = stages.begin(); si != stages.end(); ++si, ++stage_index)
+    {
+        cv::FileNode stage = *si;
+        int parent = intOr(stage["parent"], stage_index - 1);
+        int next = intOr(stage["next"], -1);
+        if (next != -1 || parent != stage_index - 1)
+        {
+            return false;
+        }
+        cv::FileNode trees = stage["trees"];
+        src.stage_first_tree.push_back(src.tree_first_node.size());
+        src.stage_threshold.push_back(
+            (float)stage["stage_threshold"] - THRESHOLD_EPS);
+        src.stage_tree_count.push_back(trees.size());
+        for (auto ti = trees.begin(); ti != trees.end(); ++ti)
+        {
+            src.beginTree();
+            int leaf_count = 0;
+            for (auto ni = (*ti).begin(); ni != (*ti).end(); ++ni)
+            {
+                cv::FileNode node = *ni;
+                cv::FileNode feature = node["feature"];
+                src.node_feature.push_back(src.feature_tilted.size());
+                src.node_threshold.push_back((float)node["threshold"]);
+                src.beginFeature(intOr(feature["tilted"], 0));
+                cv::FileNode rects = feature["rects"];
+                int slot = 0;
+                for (auto ri = rects.begin(); ri != rects.end(); ++ri, ++slot)
+                {
+                    if (!src.addHaarRect(*ri, slot))
+                    {
+                        return false;
+                    }
+                }
+
+                // A child is either another node of the tree,
+                // or a leaf (encoded as non-positive index.)
+                if (node["left_val"].empty())
+                {
+                    src.node_left.push_back(intOr(node["left_node"], 0));
+                }
+                else
+                {
+                    src.node_left.push_back(-leaf_count++);
+                    src.leaf_value.push_back((float)node["left_val"]);
+                }
+                if (node["right_val"].empty())
+                {
+                    src.node_right.push_back(intOr(node["right_node"], 0));
+                }
+                else
+                {
+                    src.node_right.push_back(-leaf_count++);
+                    src.leaf_value.push_back((float)node["right_val"]);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace.
+
+
+Cascade::Cascade() :
+    m_map       (NULL),
+    m_map_size  (0),
+    m_header    (NULL)
+{/* Empty. */}
+
+
+Cascade::~Cascade()
+{
+    clear();
+}
+
+
+void Cascade::clear()
+{
+    if (m_map)
+    {
+        munmap(m_map, m_map_size);
+        m_map = NULL;
+        m_map_size = 0;
+    }
+    m_buffer.clear();
+    m_header = NULL;
+}
+
+
+std::string Cascade::defaultCacheDir()
+{
+    boost::filesystem::path dir;
+    if (const char* xdg = getenv("XDG_CACHE_HOME"))
+    {
+        dir = xdg;
+    }
+    else if (const char* home = getenv("HOME"))
+    {
+        dir = boost::filesystem::path(home) / ".cache";
+    }
+    else
+    {
+        dir = "/tmp";
+    }
+    return (dir / "sherlock").string();
+}
+
+
+bool Cascade::load(const std::string& fname, const std::string& cache_dir)
+{
+    clear();
+
+    // Hash the XML content, and look for its compiled image.
+    std::string bytes;
+    if (!readBytes(fname, bytes))
+    {
+        return false;
+    }
+    auto hash = hashBytes(bytes);
+    std::ostringstream cache_name;
+    cache_name << std::hex << std::setw(16) << std::setfill('0') << hash << ".casc";
+    auto cache_file = boost::filesystem::path(cache_dir) / cache_name.str();
+    if (!cache_dir.empty() && mapFile(cache_file.string(), hash))
+    {
+        return true;
+    }
+
+    // Compile the XML, and cache the result (failure to
+    // write the cache is not an error.)
+    if (!compileFile(fname, hash))
+    {
+        return false;
+    }
+    if (!cache_dir.empty())
+    {
+        boost::system::error_code error;
+        boost::filesystem::create_directories(cache_dir, error);
+        writeFile(cache_file.string());
+    }
+    return true;
+}
+
+
+bool Cascade::compile(const std::string& fname)
+{
+    clear();
+    std::string bytes;
+    if (!readBytes(fname, bytes))
+    {
+        return false;
+    }
+    return compileFile(fname, hashBytes(bytes));
+}
+
+
+bool Cascade::compileFile(const std::string& fname, const uint64_t& hash)
+{
+    // Parse the XML.
+    cv::FileStorage fs (fname, cv::FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        return false;
+    }
+    cv::FileNode root = fs.getFirstTopLevelNode();
+    Source src;
+    bool ok = root["stageType"].empty() ?
+        readLegacy(root, src) : readCurrent(root, src);
+    if (!ok || src.stage_first_tree.empty() || src.width <= 0 || src.height <= 0)
+    {
+        return false;
+    }
+
+    // Fill in the header.
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.feature_type = src.feature_type;
+    header.source_hash = hash;
+    header.window_width = src.width;
+    header.window_height = src.height;
+    header.stage_count = src.stage_first_tree.size();
+    header.tree_count = src.tree_first_node.size();
+    header.node_count = src.node_feature.size();
+    header.leaf_count = src.leaf_value.size();
+    header.feature_count = src.feature_tilted.size();
+    header.subset_size = src.subset_size;
+    header.is_stump = header.node_count == header.tree_count;
+    for (auto tilted : src.feature_tilted)
+    {
+        header.has_tilted |= tilted != 0;
+    }
+    auto layout = computeLayout(
+        sizeof(Header),
+        header.stage_count,
+        header.tree_count,
+        header.node_count,
+        header.leaf_count,
+        header.feature_count,
+        header.subset_size);
+    header.size = layout.size;
+
+    // Pack the header and arrays into the buffer.
+    m_buffer.assign((layout.size + 7) / 8, 0);
+    char* data = reinterpret_cast <char*> (m_buffer.data());
+    memcpy(data, &header, sizeof(header));
+    const void* arrays[ARRAY_COUNT] = {
+        src.stage_first_tree.data(), src.stage_tree_count.data(),
+        src.stage_threshold.data(),
+        src.tree_first_node.data(), src.tree_first_leaf.data(),
+        src.node_feature.data(), src.node_threshold.data(),
+        src.node_left.data(), src.node_right.data(), src.node_subset.data(),
+        src.leaf_value.data(),
+        src.feature_rects.data(), src.feature_weights.data(),
+        src.feature_tilted.data(),
+    };
+    for (int ii = 0; ii < ARRAY_COUNT; ++ii)
+    {
+        if (layout.lengths[ii])
+        {
+            memcpy(data + layout.offsets[ii], arrays[ii], layout.lengths[ii]);
+        }
+    }
+    if (!attach(data, layout.size))
+    {
+        m_buffer.clear();
+        return false;
+    }
+    return true;
+}
+
+
+bool Cascade::mapFile(const std::string& fname, const uint64_t& hash)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    if (!attach(static_cast <const char*> (map), info.st_size)
+        || m_header->source_hash != hash)
+    {
+        m_header = NULL;
+        munmap(map, info.st_size);
+        return false;
+    }
+    m_map = map;
+    m_map_size = info.st_size;
+    return true;
+}
+
+
+bool Cascade::writeFile(const std::string& fname) const
+{
+    // Write to a temporary file first, then rename it into place,
+    // so that concurrent readers never see a partial image.
+    std::ostringstream tmp_name;
+    tmp_name << fname << ".tmp." << getpid();
+    {
+        std::ofstream file (tmp_name.str().c_str(), std::ios::out | std::ios::binary);
+        file.write(reinterpret_cast <const char*> (m_header), m_header->size);
+        if (!file)
+        {
+            unlink(tmp_name.str().c_str());
+            return false;
+        }
+    }
+    return rename(tmp_name.str().c_str(), fname.c_str()) == 0;
+}
+
+
+bool Cascade::attach(const char* data, const size_t& size)
+{
+    // Verify the header.
+    auto header = reinterpret_cast <const Header*> (data);
+    if (size < sizeof(Header)
+        || memcmp(header->magic, MAGIC, sizeof(MAGIC))
+        || header->version != FORMAT_VERSION
+        || header->size != size
+        || (header->feature_type != HAAR && header->feature_type != LBP)
+        || header->window_width <= 0 || header->window_height <= 0
+        || header->stage_count <= 0 || header->tree_count < 0
+        || header->node_count < 0 || header->leaf_count < 0
+        || header->feature_count < 0 || header->subset_size < 0
+        || (header->feature_type == LBP) != (header->subset_size > 0)
+        || (header->feature_type == LBP && header->subset_size < LBP_SUBSET_SIZE))
+    {
+        return false;
+    }
+    auto layout = computeLayout(
+        sizeof(Header),
+        header->stage_count,
+        header->tree_count,
+        header->node_count,
+        header->leaf_count,
+        header->feature_count,
+        header->subset_size);
+    if (layout.size != size)
+    {
+        return false;
+    }
+
+    // Point the accessors into the arrays.
+    auto at = [&](int array) { return data + layout.offsets[array]; };
+    m_stage_first_tree = reinterpret_cast <const int32_t*> (at(STAGE_FIRST_TREE));
+    m_stage_tree_count = reinterpret_cast <const int32_t*> (at(STAGE_TREE_COUNT));
+    m_stage_threshold  = reinterpret_cast <const float*>   (at(STAGE_THRESHOLD));
+    m_tree_first_node  = reinterpret_cast <const int32_t*> (at(TREE_FIRST_NODE));
+    m_tree_first_leaf  = reinterpret_cast <const int32_t*> (at(TREE_FIRST_LEAF));
+    m_node_feature     = reinterpret_cast <const int32_t*> (at(NODE_FEATURE));
+    m_node_threshold   = reinterpret_cast <const float*>   (at(NODE_THRESHOLD));
+    m_node_left        = reinterpret_cast <const int32_t*> (at(NODE_LEFT));
+    m_node_right       = reinterpret_cast <const int32_t*> (at(NODE_RIGHT));
+    m_node_subset      = reinterpret_cast <const int32_t*> (at(NODE_SUBSET));
+    m_leaf_value       = reinterpret_cast <const float*>   (at(LEAF_VALUE));
+    m_feature_rects    = reinterpret_cast <const int32_t*> (at(FEATURE_RECTS));
+    m_feature_weights  = reinterpret_cast <const float*>   (at(FEATURE_WEIGHTS));
+    m_feature_tilted   = reinterpret_cast <const int32_t*> (at(FEATURE_TILTED));
+
+    // Verify that all indices stay within their arrays
+    // (guards against stale or corrupt cache files.)
+    for (int ii = 0; ii < header->stage_count; ++ii)
+    {
+        if (m_stage_first_tree[ii] < 0 || m_stage_tree_count[ii] < 0
+            || m_stage_first_tree[ii] + m_stage_tree_count[ii] > header->tree_count)
+        {
+            return false;
+        }
+    }
+    for (int ii = 0; ii < header->tree_count; ++ii)
+    {
+        // The nodes and leaves of a tree run up to those of the next one.
+        const int first_node = m_tree_first_node[ii];
+        const int first_leaf = m_tree_first_leaf[ii];
+        const int end_node = ii + 1 < header->tree_count ?
+            m_tree_first_node[ii + 1] : header->node_count;
+        const int end_leaf = ii + 1 < header->tree_count ?
+            m_tree_first_leaf[ii + 1] : header->leaf_count;
+        if (first_node < 0 || first_node >= end_node || end_node > header->node_count
+            || first_leaf < 0 || first_leaf >= end_leaf || end_leaf > header->leaf_count)
+        {
+            return false;
+        }
+
+        // A child is either a node further down the tree (so that
+        // every walk ends), or a leaf of the tree.
+        for (int node = first_node; node < end_node; ++node)
+        {
+            const int32_t children[2] = { m_node_left[node], m_node_right[node] };
+            for (auto child : children)
+            {
+                if (child > 0 ?
+                    child <= node - first_node || first_node + child >= end_node :
+                    -child >= end_leaf - first_leaf)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    for (int ii = 0; ii < header->node_count; ++ii)
+    {
+        if (m_node_feature[ii] < 0 || m_node_feature[ii] >= header->feature_count)
+        {
+            return false;
+        }
+    }
+
+    // Verify that all feature rectangles lie within the window
+    // (the evaluator reads the integral images at their corners.)
+    const int width = header->window_width;
+    const int height = header->window_height;
+    for (int ii = 0; ii < header->feature_count; ++ii)
+    {
+        for (int slot = 0; slot < 3; ++slot)
+        {
+            const int32_t* r = m_feature_rects + ii*12 + slot*4;
+            const int x = r[0], y = r[1], w = r[2], h = r[3];
+            bool inside;
+            if (header->feature_type == LBP)
+            {
+                // A 3x3 grid of cells (only the first slot is used.)
+                inside = slot > 0
+                    || (x >= 0 && y >= 0 && w >= 0 && h >= 0
+                        && x + 3*w <= width && y + 3*h <= height);
+            }
+            else if (m_feature_tilted[ii])
+            {
+                // Rotated by 45 degrees, from its top corner.
+                inside = w >= 0 && h >= 0 && x - h >= 0 && y >= 0
+                    && x + w <= width && y + w + h <= height;
+            }
+            else
+            {
+                inside = x >= 0 && y >= 0 && w >= 0 && h >= 0
+                    && x + w <= width && y + h <= height;
+            }
+            if (!inside)
+            {
+                return false;
+            }
+        }
+    }
+    m_header = header;
+    return true;
+}
+
+
+Cascade::FeatureType Cascade::featureType() const
+{
+    return static_cast <FeatureType> (m_header->feature_type);
+}
+
+cv::Size Cascade::windowSize() const
+{
+    return cv::Size(m_header->window_width, m_header->window_height);
+}
+
+uint64_t Cascade::sourceHash() const { return m_header->source_hash; }
+int Cascade::stageCount() const { return m_header->stage_count; }
+int Cascade::treeCount() const { return m_header->tree_count; }
+int Cascade::nodeCount() const { return m_header->node_count; }
+int Cascade::leafCount() const { return m_header->leaf_count; }
+int Cascade::featureCount() const { return m_header->feature_count; }
+int Cascade::subsetSize() const { return m_header->subset_size; }
+bool Cascade::hasTilted() const { return m_header->has_tilted != 0; }
+bool Cascade::isStump() const { return m_header->is_stump != 0; }
+
+}  // namespace sherlock.
@@ -1,55 +1,198 @@
+// Include standard headers.
+#include <algorithm>
+
+// Include 3rd party headers.
+#include <boost/filesystem.hpp>
+
 // Include application headers.
 #include "sherlock.hpp"
 
 namespace sherlock {
 
-void Classifier::run ()
+bool Classifier::load ()
 {
-    // Pull from the queue while there are valid matrices.
-    cv::Mat* frame;
-    m_input_queue.wait_and_pop(frame);
-    while(frame)
+    // With the native evaluator selected, map the compiled cascade
+    // (compiling and caching it on first use.)  The OpenCV classifier
+    // is loaded only if the native evaluator is not selected, or cannot
+    // be used with the cascade (e.g. with tree-structured legacy ones.)
+    Parameters params = m_params.get();
+    if(params.native)
+    {
+        m_cascade.load(m_fname, m_cache_dir);
+    }
+    if(!useNative(params) && !m_cv_classifier.load(m_fname))
+    {
+        return false;
+    }
+    m_ready = true;
+    return true;
+}
+
+float Classifier::getResolution (
+    const Parameters& params,
+    const cv::Size& size) const
+{
+    if(params.resolution != AUTO_RESOLUTION)
+    {
+        return std::min(1.f, params.resolution);
+    }
+
+    // Scale the smallest objects down to the cascade window.
+    cv::Size window = m_cascade.empty()
+        ? m_cv_classifier.getOriginalWindowSize()
+        : m_cascade.windowSize();
+    float min_width = size.width*params.min_size_ratio;
+    float min_height = size.height*params.min_size_ratio;
+    if(window.area() == 0 || min_width < 1 || min_height < 1)
     {
-        std::vector<cv::Rect> rects;
-        cv::Size min_size (
-            frame->size().width*m_min_size_ratio,
-            frame->size().height*m_min_size_ratio);
-        cv::Size max_size (
-            frame->size().width*m_max_size_ratio,
-            frame->size().height*m_max_size_ratio);
+        return 1;
+    }
+    return std::min(1.f, std::max(window.width / min_width, window.height / min_height));
+}
+
+void Classifier::detect (
+    const cv::Mat* frame,
+    const Parameters& params,
+    std::vector <cv::Rect>& rects,
+    const float& scale)
+{
+    Span span (m_trace_name);
+    span.setFrame(frame);
+    rects.clear();
+
+    // At reduced resolution (of the overloaded input queue, and
+    // of detection), detect in a scaled-down copy of the frame.
+    float resolution = scale*getResolution(params, frame->size());
+    cv::Size size = Pyramid::reducedSize(frame->size(), resolution);
+    cv::Size min_size (
+        size.width*params.min_size_ratio,
+        size.height*params.min_size_ratio);
+    cv::Size max_size (
+        size.width*params.max_size_ratio,
+        size.height*params.max_size_ratio);
+    if(useNative(params))
+    {
+        // Use the frame's pyramid shared by all classifiers
+        // (detecting at the same resolution.)
+        auto pyramid = m_pyramids.get(frame, params.scale_factor, resolution);
+        m_evaluator.setTiles(params.tiles);
+        m_evaluator.setExclusion(params.exclusion);
+        m_evaluator.detectMultiScale(
+            *pyramid,
+            rects,
+            params.min_neighbors,
+            min_size,
+            max_size
+            );
+    }
+    else
+    {
+        // The OpenCV classifier may need loading first,
+        // in case the engine was switched on reload.
+        std::lock_guard <std::mutex> locker (m_cv_mutex);
+        if(m_cv_classifier.empty() && !m_cv_classifier.load(m_fname))
+        {
+            return;
+        }
+        cv::Mat reduced;
+        MatPool::attach(reduced);
+        if(size != frame->size())
+        {
+            cv::resize(*frame, reduced, size, 0, 0, CV_INTER_AREA);
+        }
+        const cv::Mat& image = size != frame->size() ? reduced : *frame;
         m_cv_classifier.detectMultiScale(
-            *frame,
+            image,
             rects,
-            m_scale_factor,
-            m_min_neighbors,
+            params.scale_factor,
+            params.min_neighbors,
             0,    // flags.
             min_size,
             max_size
             );
 
-        // Add rectangles to the data queue.
-        for(auto rect : rects) 
+        // OpenCV scans every window, hence objects centered
+        // in excluded areas can only be dropped afterwards.
+        if(params.exclusion)
         {
-            m_output_queue.push({ rect, m_color });
+            rects.erase(std::remove_if(rects.begin(), rects.end(),
+                [&params, &size](const cv::Rect& rect) {
+                    return params.exclusion->excludes(cv::Point2f(
+                        (rect.x + rect.width / 2) / (float)size.width,
+                        (rect.y + rect.height / 2) / (float)size.height)); }),
+                rects.end());
         }
+    }
 
-        // Filter out excess images in the input queue.
-        // Detection framerate is more likely (than not) to be slower than
-        // capture framerate, hence the "lossy filtering" here.
-        // Add all dropped frames and processed frames to "done" queue.
-        int count = 0;
-        auto prev_frame = frame;
-        while(m_input_queue.try_pop(frame))
-        {
-            m_done_queue.push(prev_frame);
-            prev_frame = frame;
-            count++;
-        }
-        if(count == 0)
+    // Map rectangles back to the frame.
+    if(size != frame->size())
+    {
+        scaleRects(rects, (double)frame->cols / size.width);
+    }
+}
+
+void Classifier::publish (
+    const cv::Mat* frame,
+    const std::vector <cv::Rect>& rects)
+{
+    auto detections = m_pool.acquire();
+    detections->frame = frame;
+    detections->classifier = m_index;
+    for(auto& rect : rects)
+    {
+        detections->push_back(rect);
+    }
+    m_output_queue.push(detections);
+    if(m_result_callback)
+    {
+        m_result_callback(frame, m_fname, rects);
+    }
+}
+
+void Classifier::run ()
+{
+    auto name = "classifier " + boost::filesystem::path(m_fname).stem().string();
+    applyPlacement(name, m_placement);
+    Trace::setThreadName(name);
+    PerfCounters::attach(name);
+    MatPool::setStage("classifier");
+
+    // Pass frames straight through until the cascade is loaded
+    // (or until the end, if it never is.)
+    cv::Mat* frame;
+    float scale;
+    m_input_queue.wait_and_pop(frame, scale);
+    while(frame && !m_ready)
+    {
+        m_done_queue.push(frame);
+        m_input_queue.wait_and_pop(frame, scale);
+    }
+
+    // Pull from the queue while there are valid matrices.
+    // Excess frames (detection is more likely than not to be slower
+    // than capture) are dropped by the input queue's overload policy.
+    std::vector<cv::Rect> rects;
+    while(frame)
+    {
+        if(m_paused)
         {
-            m_done_queue.push(prev_frame);
-            m_input_queue.wait_and_pop(frame);
+            m_done_queue.push(frame);
+            m_input_queue.wait_and_pop(frame, scale);
+            continue;
         }
+
+        // Take a consistent snapshot of (possibly reloaded) parameters.
+        auto params = m_params.get();
+
+        detect(frame, params, rects, scale);
+
+        // Add rectangles to the data queue.
+        publish(frame, rects);
+        PerfCounters::frameDone();
+
+        // Pass on the processed frame, and retrieve the next.
+        m_done_queue.push(frame);
+        m_input_queue.wait_and_pop(frame, scale);
     }
 }
 
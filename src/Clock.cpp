@@ -0,0 +1,59 @@
+/**
+   The Clock classes implement injectable sources of time.
+*/
+
+// Include standard headers.
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+boost::posix_time::ptime Clock::now()
+{
+    return boost::posix_time::microsec_clock::universal_time();
+}
+
+
+void Clock::sleep(const boost::posix_time::time_duration& duration)
+{
+    auto microsec = duration.total_microseconds();
+    if (microsec > 0)
+    {
+        usleep(microsec);
+    }
+}
+
+
+Clock& Clock::system()
+{
+    static Clock clock;
+    return clock;
+}
+
+
+void ReplayClock::set(const boost::posix_time::ptime& now)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_now = now;
+}
+
+
+boost::posix_time::ptime ReplayClock::now()
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    return m_now;
+}
+
+
+void ReplayClock::sleep(const boost::posix_time::time_duration& duration)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    if (!duration.is_negative() && !m_now.is_not_a_date_time())
+    {
+        m_now += duration;
+    }
+}
+
+}  // namespace sherlock.
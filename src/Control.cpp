@@ -0,0 +1,241 @@
+/**
+   The Control class implements the control socket.
+*/
+
+// Include standard headers.
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+// Include system headers.
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Maximum number of clients connected at once.
+const size_t MAX_CLIENTS = 8;
+
+// Maximum length of a command line.
+const size_t MAX_LINE = 4096;
+
+// Maximum length of replies queued for a client (which is
+// disconnected when falling behind by more.)
+const size_t MAX_OUTPUT = 1 << 24;
+
+// Send as much of given queued data as the socket takes (without
+// blocking), removing it from the queue; return false on failure.
+bool flush(const int& fd, std::string& output)
+{
+    while (!output.empty())
+    {
+        ssize_t sent = send(fd, output.data(), output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        output.erase(0, sent);
+    }
+    return true;
+}
+
+}  // namespace.
+
+
+Control::Control(
+    Handler handler,
+    std::function <void (int)> on_clients
+    ) :
+    m_handler    (handler),
+    m_on_clients (on_clients),
+    m_listen_fd  (-1),
+    m_stop_fd    (eventfd(0, EFD_CLOEXEC))
+{/* Empty. */}
+
+
+Control::~Control()
+{
+    if (m_listen_fd >= 0)
+    {
+        close(m_listen_fd);
+        unlink(m_path.c_str());
+    }
+    if (m_stop_fd >= 0)
+    {
+        close(m_stop_fd);
+    }
+}
+
+
+bool Control::open(const std::string& path)
+{
+    struct sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0
+        || listen(fd, MAX_CLIENTS) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_path = path;
+    m_listen_fd = fd;
+    return true;
+}
+
+
+void Control::stop()
+{
+    uint64_t one = 1;
+    if (m_stop_fd >= 0 && write(m_stop_fd, &one, sizeof(one)) < 0)
+    {
+        std::cout << "Warning: Failed to stop control " << m_path << std::endl;
+    }
+}
+
+
+void Control::run()
+{
+    if (m_listen_fd < 0 || m_stop_fd < 0)
+    {
+        return;
+    }
+
+    // Connected clients, with their partial command lines
+    // and the replies queued for them.
+    struct Client
+    {
+        std::string line;
+        std::string output;
+    };
+    std::map <int, Client> clients;
+    while (true)
+    {
+        std::vector <struct pollfd> fds = {
+            { m_stop_fd, POLLIN, 0 },
+            { m_listen_fd, POLLIN, 0 },
+        };
+        for (auto& client : clients)
+        {
+            fds.push_back({
+                client.first,
+                (short)(client.second.output.empty() ? POLLIN : POLLIN | POLLOUT),
+                0 });
+        }
+        int count = poll(fds.data(), fds.size(), -1);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0 || fds[0].revents)
+        {
+            break;
+        }
+
+        // Accept a new client (unless too many are connected.)
+        if (fds[1].revents & POLLIN)
+        {
+            int fd = accept4(m_listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0 && clients.size() < MAX_CLIENTS)
+            {
+                clients[fd];
+                m_on_clients(clients.size());
+            }
+            else if (fd >= 0)
+            {
+                std::string error ("ERROR too many clients\n");
+                flush(fd, error);
+                close(fd);
+            }
+        }
+
+        // Serve the complete command lines of clients, and send what
+        // clients take of their replies.  Clients which hung up, or
+        // fell behind by more than the output bound, are disconnected.
+        for (size_t ii = 2; ii < fds.size(); ++ii)
+        {
+            if (!fds[ii].revents)
+            {
+                continue;
+            }
+            int fd = fds[ii].fd;
+            auto& client = clients[fd];
+            bool alive = true;
+            if (fds[ii].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                char buffer[1024];
+                ssize_t length = read(fd, buffer, sizeof(buffer));
+                alive = length > 0 || (length < 0
+                    && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+                client.line.append(buffer, std::max <ssize_t> (length, 0));
+            }
+            auto& line = client.line;
+            size_t end;
+            while (alive && (end = line.find('\n')) != std::string::npos)
+            {
+                auto command = line.substr(0, end);
+                line.erase(0, end + 1);
+                if (!command.empty() && command.back() == '\r')
+                {
+                    command.pop_back();
+                }
+                std::string reply;
+                std::ostringstream header;
+                if (m_handler(command, reply))
+                {
+                    header << "OK " << reply.size() << "\n";
+                }
+                else
+                {
+                    header << "ERROR " << reply << "\n";
+                    reply.clear();
+                }
+                client.output += header.str();
+                client.output += reply;
+            }
+            alive = alive && flush(fd, client.output);
+            if (!alive || line.size() > MAX_LINE || client.output.size() > MAX_OUTPUT)
+            {
+                close(fd);
+                clients.erase(fd);
+                m_on_clients(clients.size());
+            }
+        }
+    }
+
+    for (auto& client : clients)
+    {
+        close(client.first);
+    }
+    m_on_clients(0);
+}
+
+}  // namespace sherlock.
@@ -3,10 +3,20 @@
 
 namespace sherlock {
 
+void Deallocator::expect(cv::Mat* frame, const int& count)
+{
+    std::lock_guard <std::mutex> locker (m_expected_mutex);
+    m_expected[frame] = count;
+}
+
 // Deallocate frames in given queue.
 // Deallocate a frame when its count reaches trigger threshold.
 void Deallocator::run ()
 {
+    applyPlacement("deallocator", m_placement);
+    Trace::setThreadName("deallocator");
+    PerfCounters::attach("deallocator");
+
     // Count the number of times each frame is encountered
     // in the "done" queue (to know when the count triggers
     // deallocation.)
@@ -28,10 +38,32 @@ void Deallocator::run ()
         }
         
         // Perform deallocation, if triggered.
-        if(done_counts[frame] == m_trigger)
+        // The frame's own trigger (if any) is dropped before the frame
+        // is deleted, as the address may be reused right after.
+        int trigger = m_trigger;
+        {
+            std::lock_guard <std::mutex> locker (m_expected_mutex);
+            auto expected = m_expected.find(frame);
+            if(expected != m_expected.end())
+            {
+                trigger = expected->second;
+                if(done_counts[frame] == trigger)
+                {
+                    m_expected.erase(expected);
+                }
+            }
+        }
+        if(done_counts[frame] == trigger)
         {
+            Span span ("free");
+            span.setFrame(frame);
+            if(m_release_callback)
+            {
+                m_release_callback(frame);
+            }
             delete frame;
             done_counts.erase(frame);
+            PerfCounters::frameDone();
         }
         
         // Retrieve the next frame.
@@ -0,0 +1,233 @@
+/**
+   The Decoder class implements read-ahead decoding of file sources.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <iomanip>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Video frames are timed from a fixed origin, so that
+// replays of a video are identical.
+const boost::posix_time::ptime ORIGIN (boost::gregorian::date(1970, 1, 1));
+
+// Return true if given four-character code is of Motion JPEG.
+bool isMjpeg(const int& fourcc)
+{
+    return fourcc == CV_FOURCC('M', 'J', 'P', 'G') || fourcc == CV_FOURCC('m', 'j', 'p', 'g');
+}
+
+// Return the milliseconds elapsed since given time.
+double elapsedMsec(const Pacer::Clock::time_point& start)
+{
+    return std::chrono::duration <double, std::milli> (Pacer::now() - start).count();
+}
+
+}  // namespace.
+
+
+Decoder::Decoder(const int& threads, const int& depth) :
+    m_threads  (std::max(1, threads)),
+    m_depth    (std::max(1, depth)),
+    m_is_video (false),
+    m_is_mjpeg (false),
+    m_read     (0),
+    m_taken    (0),
+    m_ended    (false),
+    m_stopping (false),
+    m_stats    ({ 0, 0, 0 })
+{/* Empty. */}
+
+
+Decoder::~Decoder()
+{
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        m_stopping = true;
+    }
+    m_room.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    for (auto& decoded : m_frames)
+    {
+        delete decoded.second.frame;
+    }
+}
+
+
+bool Decoder::open(const std::string& fname)
+{
+    if (!m_recording.open(fname))
+    {
+        if (!m_video.open(fname))
+        {
+            return false;
+        }
+
+        // Motion JPEG frames are independent of one another, hence
+        // split from the file and decoded by all threads, as those
+        // of a recording; other videos are decoded as they are read.
+        if (isMjpeg((int)m_video.get(CV_CAP_PROP_FOURCC))
+            && m_mjpeg.open(fname, ORIGIN, m_video.get(CV_CAP_PROP_FPS)))
+        {
+            m_video.release();
+            m_is_mjpeg = true;
+        }
+        else
+        {
+            m_is_video = true;
+        }
+    }
+    for (int ii = 0; ii < (m_is_video ? 1 : m_threads); ++ii)
+    {
+        m_workers.push_back(std::thread(&Decoder::decode, this));
+    }
+    return true;
+}
+
+
+bool Decoder::read(cv::Mat*& frame, boost::posix_time::ptime& tstamp)
+{
+    auto start = Pacer::now();
+    std::unique_lock <std::mutex> locker (m_mutex);
+    m_decoded.wait(locker, [this] {
+            return m_frames.count(m_taken) || (m_ended && m_taken == m_read); });
+    m_stats.wait_msec += elapsedMsec(start);
+    auto found = m_frames.find(m_taken);
+    if (found == m_frames.end())
+    {
+        return false;
+    }
+    frame = found->second.frame;
+    tstamp = found->second.tstamp;
+    m_frames.erase(found);
+    ++m_taken;
+    locker.unlock();
+    m_room.notify_all();
+
+    // A frame failing to decode ends the file.
+    if (frame->empty())
+    {
+        delete frame;
+        frame = NULL;
+        return false;
+    }
+    return true;
+}
+
+
+Decoder::Stats Decoder::getStats()
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    return m_stats;
+}
+
+
+void Decoder::report(std::ostream& out)
+{
+    auto stats = getStats();
+    out << std::fixed << std::setprecision(1)
+        << "Decoded " << stats.frames << " frames in " << stats.decode_msec << " msec ("
+        << (stats.frames > 0 ? stats.decode_msec / stats.frames : 0.)
+        << " msec per frame, on " << m_workers.size() << " threads), waited "
+        << stats.wait_msec << " msec for decoding" << std::endl;
+}
+
+
+void Decoder::decode()
+{
+    MatPool::setStage("decoder");
+    Trace::setThreadName("decoder");
+    PerfCounters::attach("decoder");
+
+    std::vector <uchar> buffer;
+    while (true)
+    {
+        Decoded decoded;
+        decoded.frame = new cv::Mat;
+        MatPool::attach(*decoded.frame);
+        double msec = 0;
+        long sequence;
+
+        // Frames are read in order, as there is room ahead.
+        {
+            std::unique_lock <std::mutex> locker (m_mutex);
+            m_room.wait(locker, [this] {
+                    return m_stopping || m_ended || m_read - m_taken < m_depth; });
+            bool read = !m_stopping && !m_ended;
+            if (read && m_is_mjpeg)
+            {
+                read = m_mjpeg.readEncoded(buffer, decoded.tstamp);
+                m_ended = !read;
+            }
+            else if (read && !m_is_video)
+            {
+                read = m_recording.readEncoded(buffer, decoded.tstamp);
+                m_ended = !read;
+            }
+            if (!read)
+            {
+                locker.unlock();
+                m_decoded.notify_all();
+                m_room.notify_all();
+                delete decoded.frame;
+                return;
+            }
+            sequence = m_read++;
+        }
+
+        // Decode the frame (outside the lock.)  A video other than
+        // Motion JPEG is decoded as it is read, by a single thread,
+        // hence in order; a frame failing to decode is passed on
+        // empty, and ends the file.
+        {
+            Span span ("decode");
+            span.startFrame(decoded.frame);
+            auto start = Pacer::now();
+            if (m_is_video)
+            {
+                if (!m_video.read(*decoded.frame))
+                {
+                    decoded.frame->release();
+                }
+                decoded.tstamp = ORIGIN + boost::posix_time::microseconds(
+                    (long)(m_video.get(CV_CAP_PROP_POS_MSEC)*1000));
+            }
+            else if (m_is_mjpeg)
+            {
+                MjpegReader::decode(buffer, *decoded.frame);
+            }
+            else
+            {
+                RecordingReader::decode(buffer, *decoded.frame);
+            }
+            msec = elapsedMsec(start);
+        }
+        bool ended = m_is_video && decoded.frame->empty();
+        {
+            std::lock_guard <std::mutex> locker (m_mutex);
+            m_frames[sequence] = decoded;
+            if (ended)
+            {
+                m_ended = true;
+            }
+            else
+            {
+                ++m_stats.frames;
+                m_stats.decode_msec += msec;
+            }
+        }
+        PerfCounters::frameDone();
+        m_decoded.notify_all();
+    }
+}
+
+}  // namespace sherlock.
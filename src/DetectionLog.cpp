@@ -0,0 +1,71 @@
+/**
+   The DetectionLog class implements logging of detections.
+*/
+
+// Include standard headers.
+#include <algorithm>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+bool DetectionLog::open(const std::string& fname)
+{
+    m_file.open(fname.c_str(), std::ios::out | std::ios::trunc);
+    return m_file.is_open();
+}
+
+
+void DetectionLog::capture(const cv::Mat* frame)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_entries[frame].number = m_count++;
+}
+
+
+void DetectionLog::add(
+    const cv::Mat* frame,
+    const std::string& classifier,
+    const std::vector <cv::Rect>& rects)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    auto& detections = m_entries[frame].detections;
+    for (auto rect : rects)
+    {
+        detections.push_back({ classifier, rect });
+    }
+}
+
+
+void DetectionLog::release(const cv::Mat* frame)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    auto entry = m_entries.find(frame);
+    if (entry == m_entries.end())
+    {
+        return;
+    }
+    auto& detections = entry->second.detections;
+    std::sort(
+        detections.begin(), detections.end(),
+        [](const std::pair <std::string, cv::Rect>& a,
+           const std::pair <std::string, cv::Rect>& b) {
+            if (a.first != b.first) return a.first < b.first;
+            if (a.second.x != b.second.x) return a.second.x < b.second.x;
+            if (a.second.y != b.second.y) return a.second.y < b.second.y;
+            if (a.second.width != b.second.width) return a.second.width < b.second.width;
+            return a.second.height < b.second.height;
+        });
+    for (auto& detection : detections)
+    {
+        auto& rect = detection.second;
+        m_file << entry->second.number << " " << detection.first << " "
+               << rect.x << " " << rect.y << " "
+               << rect.width << " " << rect.height << "\n";
+    }
+    m_file.flush();
+    m_entries.erase(entry);
+}
+
+}  // namespace sherlock.
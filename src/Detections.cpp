@@ -0,0 +1,100 @@
+/**
+   Detections batches, their pool, and classifier colors.
+*/
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+void Detections::clear()
+{
+    x.clear();
+    y.clear();
+    width.clear();
+    height.clear();
+    label.clear();
+    score.clear();
+}
+
+
+void Detections::push_back(const cv::Rect& rect)
+{
+    x.push_back(cv::saturate_cast <int16_t> (rect.x));
+    y.push_back(cv::saturate_cast <int16_t> (rect.y));
+    width.push_back(cv::saturate_cast <int16_t> (rect.width));
+    height.push_back(cv::saturate_cast <int16_t> (rect.height));
+}
+
+
+void Detections::push_back(
+    const cv::Rect& rect,
+    const int& classifier,
+    const float& confidence)
+{
+    push_back(rect);
+    label.push_back(classifier);
+    score.push_back(confidence);
+}
+
+
+DetectionsPool::~DetectionsPool()
+{
+    for (auto detections : m_free)
+    {
+        delete detections;
+    }
+}
+
+
+Detections* DetectionsPool::acquire()
+{
+    Detections* detections = NULL;
+    {
+        std::lock_guard <std::mutex> locker (m_mutex);
+        if (!m_free.empty())
+        {
+            detections = m_free.back();
+            m_free.pop_back();
+        }
+    }
+    if (!detections)
+    {
+        detections = new Detections;
+    }
+    detections->frame = NULL;
+    detections->classifier = -1;
+    detections->clear();
+    return detections;
+}
+
+
+void DetectionsPool::release(Detections* detections)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_free.push_back(detections);
+}
+
+
+int Palette::add(const cv::Scalar& color)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_colors.push_back(color);
+    return m_colors.size() - 1;
+}
+
+
+void Palette::set(const int& index, const cv::Scalar& color)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_colors[index] = color;
+}
+
+
+cv::Scalar Palette::get(const int& index)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    return m_colors[index];
+}
+
+}  // namespace sherlock.
@@ -3,7 +3,13 @@
 */
 
 // Include standard headers.
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 
 // Include 3rd party headers.
 #include <boost/filesystem.hpp>
@@ -22,124 +28,843 @@ Detector::Detector(
     const float& max_fps,
     const std::string& config_fname
     ) :
+    m_config_fname(config_fname),
+    m_source(std::to_string(device)),
     m_captor(device, width, height, duration, max_fps),
     m_displayer(
         m_display_queue, 
         m_done_queue, 
-        m_rect_colors,
+        m_detections,
+        m_detections_pool,
+        m_palette,
 
         //m_captor),
         std::bind(&sherlock::Captor::getFramerate, &m_captor)),
 
-    m_deallocator(m_done_queue)
+    m_deallocator(m_done_queue),
+    m_watcher(config_fname, std::bind(&Detector::reload, this)),
+    m_control(
+        std::bind(&Detector::command, this,
+                  std::placeholders::_1, std::placeholders::_2),
+        std::bind(&Detector::meter, this, std::placeholders::_1)),
+    m_metering(false),
+    m_latency_count(0),
+    m_latency_mean(0),
+    m_latency_max(0),
+    m_displayed(false),
+    m_classifier_threads(1),
+    m_batched(false),
+    m_fused(false),
+    m_fuser(m_fusion_queue, m_detections, m_detections_pool)
 {
-    // Add display queue as video capture output.
-    m_captor.addOutput (m_display_queue);
+    // Frames dropped by the overload policy of any queue
+    // are passed on as done with.
+    auto drop = [this](cv::Mat* const& frame) { m_done_queue.push(frame); };
+    m_display_queue.setDropCallback(drop);
+    m_batch_queue.setDropCallback(drop);
 
-    // Load the configuration file.
-    bites::Config config (config_fname);
+    // Have every captured frame deallocated once it has passed
+    // through all outputs it was pushed onto (the number of outputs
+    // changes as classifiers are added or retired on reload.)
+    m_captor.setFanoutCallback (
+        [this](cv::Mat* frame, int count) {
+            if (m_detection_log.isOpen())
+            {
+                m_detection_log.capture(frame);
+            }
+            if (m_events.isOpen())
+            {
+                m_events.capture(frame, m_captor.getClock().now());
+            }
+            if (m_metering)
+            {
+                std::lock_guard <std::mutex> locker (m_latency_mutex);
+                m_capture_times[frame] = Pacer::now();
+            }
+            // Without any outputs (a headless graph whose classifiers
+            // were all retired, or never configured), the frame is done
+            // with right away.
+            if (count == 0)
+            {
+                m_deallocator.expect(frame, 1);
+                m_done_queue.push(frame);
+                return;
+            }
+            m_deallocator.expect(frame, count);
+        });
+
+    // Drop the frame's shared pyramids before deallocation, have
+    // its detections fused (all classifiers have published theirs
+    // by now), and let the captor know (for replaying in lockstep.)
+    m_deallocator.setReleaseCallback (
+        [this](cv::Mat* frame) {
+            m_pyramids.release(frame);
+            if (m_metering)
+            {
+                std::lock_guard <std::mutex> locker (m_latency_mutex);
+                auto captured = m_capture_times.find(frame);
+                if (captured != m_capture_times.end())
+                {
+                    double latency = std::chrono::duration <double, std::milli> (
+                        Pacer::now() - captured->second).count();
+                    m_capture_times.erase(captured);
+                    ++m_latency_count;
+                    m_latency_mean += (latency - m_latency_mean) / m_latency_count;
+                    m_latency_max = std::max(m_latency_max, latency);
+                }
+            }
+            if (!m_displayed)
+            {
+                // Without a display, detections are done with
+                // (all classifiers have published theirs by now.)
+                Detections* detections;
+                while (m_detections.try_pop(detections))
+                {
+                    m_detections_pool.release(detections);
+                }
+            }
+            if (m_fused)
+            {
+                auto marker = m_detections_pool.acquire();
+                marker->frame = frame;
+                marker->classifier = Detections::END_OF_FRAME;
+                m_fusion_queue.push(marker);
+            }
+            if (m_detection_log.isOpen())
+            {
+                m_detection_log.release(frame);
+            }
+            if (m_events.isOpen())
+            {
+                m_events.release(frame);
+            }
+            m_captor.frameDone(frame);
+        });
+
+    // Create the classifier workers (their cascades
+    // are loaded later, while the pipeline is running.)
+    ClassifierSettings settings;
+    auto entries = readClassifierConfig(config_fname, settings, m_source);
 
-    // Iterate the configuration entries.
-    for(auto fname : config.keys())
+    // Instantiate the processing graph: the display (if any)
+    // takes frames from capture, as do the classifiers or batch.
+    auto& graph = settings.graph;
+    m_graph = describeGraph(graph);
+    std::cout << "Processing graph:\n" << m_graph << std::flush;
+    m_displayed = graph.find(GraphStage::DISPLAY) != NULL;
+    if (m_displayed)
     {
-        // Skip the DIRS setting 
-        // (only remainder of file is actual classifier listing.)
-        if(fname == "DIRS")
+        m_captor.addOutput(m_display_queue);
+    }
+    m_display_queue.setPolicy(settings.display_policy);
+    m_displayer.setMaxWidth(settings.display_width);
+
+    // Place the threads (as they start.)
+    auto fusion = graph.find(GraphStage::FUSION);
+    m_classifier_placement = settings.classifier_placement;
+    m_captor.setPlacement(settings.capture_placement);
+    m_displayer.setPlacement(settings.display_placement);
+    m_fuser.setPlacement(fusion ? fusion->placement : settings.display_placement);
+    m_deallocator.setPlacement(settings.display_placement);
+
+    // With fusion, classifier detections go through the fuser.
+    m_fused = settings.fusion;
+    m_fuser.setParameters(settings.fusion_params);
+
+    // With the batch engine, batch threads take the frames for all
+    // classifiers (each frame processed by one of them); otherwise,
+    // every classifier has as many workers as the stage has threads.
+    m_batched = settings.batch;
+    if (m_batched)
+    {
+        m_batch_queue.setPolicy(settings.classifier_policy);
+        m_captor.addOutput(m_batch_queue);
+        for (int ii = 0; ii < graph.find(GraphStage::BATCH)->threads; ++ii)
         {
-            continue;
+            m_batches.push_back(std::unique_ptr <Batch> (
+                new Batch(m_batch_queue, m_done_queue, m_pyramids)));
+            m_batches.back()->setPlacement(settings.classifier_placement);
+        }
+    }
+    else
+    {
+        m_classifier_threads = graph.find(GraphStage::CLASSIFIERS)->threads;
+    }
+    for(auto entry : entries)
+    {
+        auto workers = addClassifier(entry, settings.cache_dir);
+        m_classifiers.insert(m_classifiers.end(), workers.begin(), workers.end());
+    }
+
+    // Dump a warning in case of no classifiers.
+    if (m_classifiers.size() == 0)
+    {
+        std::cout << "Warning: Not using any classifiers." << std::endl;
+    }
+}
+
+
+std::vector <Classifier*> Detector::addClassifier(
+    const ClassifierEntry& entry,
+    const std::string& cache_dir)
+{
+    // Create the classifier input queue (unused while batched.)
+    auto input_queue = new sherlock::Edge <cv::Mat*> (entry.policy);
+    input_queue->setDropCallback(
+        [this](cv::Mat* const& frame) { m_done_queue.push(frame); });
+
+    // Create the classifier workers, sharing the input queue
+    // (and the color.)
+    auto index = m_palette.add(entry.params.color);
+    std::vector <Classifier*> workers;
+    for (int ii = 0; ii < (m_batched ? 1 : m_classifier_threads); ++ii)
+    {
+        auto cfer = new sherlock::Classifier(
+            entry.fname,
+            cache_dir,
+            entry.params,
+            index,
+            *input_queue,
+            m_fused ? m_fusion_queue : m_detections,
+            m_detections_pool,
+            m_done_queue,
+            m_pyramids
+            );
+        cfer->setPlacement(m_classifier_placement);
+
+        // Log and stream the classifier's detections, if so configured.
+        cfer->setResultCallback(
+            std::bind(
+                &Detector::result, this,
+                std::placeholders::_1, std::placeholders::_2,
+                std::placeholders::_3));
+        workers.push_back(cfer);
+    }
+
+    // Add the classifier input queue as video capture output.
+    if (m_batched)
+    {
+        for (auto& batch : m_batches)
+        {
+            batch->addMember(workers.front());
         }
+    }
+    else
+    {
+        m_captor.addOutput(*input_queue);
+    }
+    return workers;
+}
+
 
-        // Process each classifier XML file in the configuration.
-        boost::filesystem::path file(fname + ".xml");
-        std::string dir_name;
-        std::stringstream dirs(config["DIRS"]);
-        while(dirs >> dir_name){
+bool Detector::setDetectionLog(const std::string& fname)
+{
+    if (!m_detection_log.open(fname))
+    {
+        std::cout << "Warning: Failed to create detection log "
+                  << fname << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool Detector::setEventStream(
+    const std::string& address,
+    const EventStream::Format& format)
+{
+    if (!m_events.open(address, format))
+    {
+        std::cout << "Warning: Failed to create event stream "
+                  << address << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void Detector::result(
+    const cv::Mat* frame,
+    const std::string& fname,
+    const std::vector <cv::Rect>& rects)
+{
+    if (m_detection_log.isOpen())
+    {
+        m_detection_log.add(frame, fname, rects);
+    }
+    if (m_events.isOpen())
+    {
+        m_events.publish(frame, fname, rects);
+    }
+}
 
-            // Assemble the filename.
-            boost::filesystem::path dir (dir_name);
-            boost::filesystem::path full = dir / file;
 
-            // Check validity of the XML file by creating
-            // OpenCV cascade classifier and testing its validity
-            // (skip if invalid.)
-            cv::CascadeClassifier test (full.string());
-            if(test.empty())
+bool Detector::setControl(const std::string& path)
+{
+    if (!m_control.open(path))
+    {
+        std::cout << "Warning: Failed to create control socket "
+                  << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void Detector::meter(const int& clients)
+{
+    std::lock_guard <std::mutex> locker (m_latency_mutex);
+    if (clients > 0 && !m_metering)
+    {
+        m_latency_count = 0;
+        m_latency_mean = 0;
+        m_latency_max = 0;
+    }
+    m_metering = clients > 0;
+    if (!m_metering)
+    {
+        m_capture_times.clear();
+    }
+}
+
+
+bool Detector::command(const std::string& line, std::string& reply)
+{
+    std::istringstream tokens (line);
+    std::string name;
+    tokens >> name;
+
+    if (name == "stats")
+    {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2);
+        auto fps = m_captor.getFramerate();
+        out << "capture_fps";
+        for (auto rate : fps)
+        {
+            out << " " << rate;
+        }
+        out << "\n";
+        auto pacing = m_captor.getPacingStats();
+        out << "pacing_jitter_usec " << pacing.mean << " " << pacing.stddev
+            << " " << pacing.max << " missed " << pacing.missed << "\n";
+        if (m_captor.isReplaying())
+        {
+            auto decode = m_captor.getDecodeStats();
+            out << "decode_msec " << decode.decode_msec << " frames " << decode.frames
+                << " waited " << decode.wait_msec << "\n";
+        }
+        {
+            std::lock_guard <std::mutex> locker (m_latency_mutex);
+            out << "latency_msec " << m_latency_mean << " max " << m_latency_max
+                << " frames " << m_latency_count << "\n";
+        }
+        out << "queue display depth " << m_display_queue.size()
+            << ": " << m_display_queue.getCounters() << "\n";
+        if (m_batched)
+        {
+            out << "queue batch depth " << m_batch_queue.size()
+                << ": " << m_batch_queue.getCounters() << "\n";
+        }
+        for (auto& stage : MatPool::instance().getCounters())
+        {
+            out << "matpool " << stage.first << ": " << stage.second << "\n";
+        }
+        for (auto& stage : PerfCounters::getTotals())
+        {
+            out << "perf " << stage.first << ": " << stage.second << "\n";
+        }
+        std::lock_guard <std::mutex> locker (m_classifiers_mutex);
+        const Edge <cv::Mat*>* previous = NULL;
+        for (auto classifier : m_classifiers)
+        {
+            // Workers of a classifier share their queue.
+            auto& queue = classifier->getInputQueue();
+            out << "classifier " << classifier->getFilename()
+                << (classifier->isReady() ? "" : " loading")
+                << (classifier->isPaused() ? " paused" : "");
+            if (!m_batched && &queue != previous)
+            {
+                out << " depth " << queue.size() << ": " << queue.getCounters();
+            }
+            auto tiles = classifier->getTileStats();
+            if (tiles.tiles > 0)
             {
-                continue;
+                out << " tiles_scanned " << 100. * tiles.scanned / tiles.tiles << "%";
             }
+            out << "\n";
+            previous = &queue;
+        }
+        reply = out.str();
+        return true;
+    }
 
-            // Assemble the color object.
-            int rr, gg, bb;
-            std::stringstream(config[fname]) >> rr >> gg >> bb;
-            cv::Scalar color(rr, gg, bb);
+    if (name == "pause" || name == "resume")
+    {
+        std::string which;
+        if (!(tokens >> which))
+        {
+            reply = "missing classifier name";
+            return false;
+        }
+        int count = 0;
+        std::lock_guard <std::mutex> locker (m_classifiers_mutex);
+        for (auto classifier : m_classifiers)
+        {
+            auto& fname = classifier->getFilename();
+            if (which == "all" || which == fname
+                || which == boost::filesystem::path(fname).stem().string())
+            {
+                classifier->setPaused(name == "pause");
+                ++count;
+            }
+        }
+        if (count == 0)
+        {
+            reply = "no classifier " + which;
+            return false;
+        }
+        reply = std::to_string(count) + " classifiers " + name + "d\n";
+        return true;
+    }
 
-            // Create the classifier input queue.
-            auto input_queue = new bites::ConcurrentQueue<cv::Mat*>;
-            m_classifier_inputs.push_back(input_queue);
+    if (name == "fps")
+    {
+        float max_fps;
+        if (!(tokens >> max_fps))
+        {
+            reply = "missing framerate";
+            return false;
+        }
+        m_captor.setMaxFps(max_fps);
+        reply = "max_fps " + std::to_string(max_fps) + "\n";
+        return true;
+    }
 
-            // Add the classifier input queue as video capture output.
-            m_captor.addOutput(*input_queue);
+    if (name == "frame")
+    {
+        if (!m_displayed)
+        {
+            reply = "no display stage";
+            return false;
+        }
+        std::vector <uchar> jpeg;
+        if (!m_displayer.snapshot(jpeg, 2000))
+        {
+            reply = "no frame";
+            return false;
+        }
+        reply.assign(jpeg.begin(), jpeg.end());
+        return true;
+    }
 
-            // Create the classifier worker.
-            auto cfer = new sherlock::Classifier(
-                full.string(),
-                color,
-                atof(config["SCALE_FACTOR"].c_str()),
-                atoi(config["MIN_NEIGHBORS"].c_str()),
-                atof(config["MIN_SIZE_RATIO"].c_str()),
-                atof(config["MAX_SIZE_RATIO"].c_str()),
-                *input_queue,
-                m_rect_colors,
-                m_done_queue
-                );
-            m_classifiers.push_back(cfer);
+    if (name == "trace")
+    {
+        std::string fname;
+        if (!(tokens >> fname))
+        {
+            reply = "usage: trace FILE";
+            return false;
         }
+        if (!Trace::isEnabled())
+        {
+            reply = "tracing not compiled in (build with trace=1)";
+            return false;
+        }
+        std::ofstream file (fname.c_str());
+        long spans = Trace::write(file);
+        if (!file)
+        {
+            reply = "cannot write " + fname;
+            return false;
+        }
+        reply = "spans " + std::to_string(spans) + "\n";
+        return true;
     }
 
-    // Dump a warning in case of no classifiers.
-    if (m_classifiers.size() == 0)
+    reply = "unknown command (stats, pause NAME, resume NAME, fps N, frame, trace FILE)";
+    return false;
+}
+
+
+void Detector::retireClassifier(const std::string& fname)
+{
+    std::vector <Classifier*> workers;
+    for (auto ii = m_classifiers.begin(); ii != m_classifiers.end(); )
     {
-        std::cout << "Warning: Not using any classifiers." << std::endl;
+        if ((*ii)->getFilename() == fname)
+        {
+            workers.push_back(*ii);
+            ii = m_classifiers.erase(ii);
+            continue;
+        }
+        ++ii;
+    }
+    if (workers.empty())
+    {
+        return;
+    }
+
+    // Stop feeding the workers, and signal them to finish
+    // once they have passed on all frames already queued.
+    auto& input_queue = workers.front()->getInputQueue();
+    if (m_batched)
+    {
+        for (auto& batch : m_batches)
+        {
+            batch->removeMember(workers.front());
+        }
+    }
+    else
+    {
+        m_captor.removeOutput(input_queue);
+        for (size_t ii = 0; ii < workers.size(); ++ii)
+        {
+            input_queue.push(NULL);
+        }
+        for (auto worker : workers)
+        {
+            worker->join();
+        }
+        std::cout << "Queue of " << fname << ": "
+                  << input_queue.getCounters() << std::endl;
+    }
+    for (auto worker : workers)
+    {
+        delete worker;
+    }
+    delete &input_queue;
+}
+
+
+void Detector::reload()
+{
+    std::cout << "Reloading " << m_config_fname << std::endl;
+
+    // Classifiers cannot be retired while still being loaded
+    // (those left to load are loaded anew, unless retired.)
+    auto unloaded = stopLoaders();
+
+    ClassifierSettings settings;
+    auto entries = readClassifierConfig(m_config_fname, settings, m_source);
+    std::lock_guard <std::mutex> locker (m_classifiers_mutex);
+    if (describeGraph(settings.graph) != m_graph)
+    {
+        std::cout << "Warning: Changes to the processing graph (stages, "
+                  << "threads, batch engine or FUSION) take effect on restart."
+                  << std::endl;
+    }
+    m_fuser.setParameters(settings.fusion_params);
+    m_display_queue.setPolicy(settings.display_policy);
+    m_displayer.setMaxWidth(settings.display_width);
+    m_batch_queue.setPolicy(settings.classifier_policy);
+
+    // Classifiers started from now on are placed anew
+    // (placements of running threads are left as they are.)
+    m_classifier_placement = settings.classifier_placement;
+
+    // Update parameters of classifiers still configured,
+    // and retire the others.
+    std::vector <std::string> retired;
+    for (auto classifier : m_classifiers)
+    {
+        auto& fname = classifier->getFilename();
+        auto entry = std::find_if(
+            entries.begin(), entries.end(),
+            [&fname](const ClassifierEntry& entry) { return entry.fname == fname; });
+        if (entry == entries.end())
+        {
+            if (std::find(retired.begin(), retired.end(), fname) == retired.end())
+            {
+                retired.push_back(fname);
+            }
+            continue;
+        }
+        if (entry->params.native && !classifier->getParameters().native)
+        {
+            std::cout << "Warning: Switching classifier " << fname
+                      << " to the native engine takes effect on restart." << std::endl;
+        }
+        classifier->setParameters(entry->params);
+        m_palette.set(classifier->getIndex(), entry->params.color);
+        classifier->getInputQueue().setPolicy(entry->policy);
+    }
+    for (auto& fname : retired)
+    {
+        std::cout << "Retiring classifier " << fname << std::endl;
+        retireClassifier(fname);
+    }
+
+    // Resume loading the classifiers still configured.
+    std::vector <Classifier*> resumed;
+    for (auto classifier : unloaded)
+    {
+        if (std::find(m_classifiers.begin(), m_classifiers.end(), classifier)
+            != m_classifiers.end())
+        {
+            resumed.push_back(classifier);
+        }
+    }
+    startLoaders(resumed);
+
+    // Start up classifiers newly added to the configuration.
+    for (auto entry : entries)
+    {
+        auto running = std::find_if(
+            m_classifiers.begin(), m_classifiers.end(),
+            [&entry](Classifier* classifier) { return classifier->getFilename() == entry.fname; });
+        if (running != m_classifiers.end())
+        {
+            continue;
+        }
+        std::cout << "Adding classifier " << entry.fname << std::endl;
+        for (auto classifier : addClassifier(entry, settings.cache_dir))
+        {
+            m_classifiers.push_back(classifier);
+            if (!m_batched)
+            {
+                classifier->start();
+            }
+            if(!classifier->load())
+            {
+                std::cout << "Warning: Failed to load classifier "
+                          << classifier->getFilename() << std::endl;
+            }
+        }
     }
 }
 
 
 void Detector::run()
 {
-    // Start up the classifier threads.
+    // Start up the classifier threads (or the batch hosting them.)
+    // Until its cascade is loaded, a classifier passes frames straight
+    // through, hence the pipeline needs not wait for the loading.
+    for (auto& batch : m_batches)
+    {
+        batch->start();
+    }
     for(auto classifier : m_classifiers)
     {
-        classifier->start();
+        if (!m_batched)
+        {
+            classifier->start();
+        }
+    }
+
+    // Start up the loader threads, loading cascades concurrently.
+    startLoaders({ m_classifiers.begin(), m_classifiers.end() });
+
+    // A replay is to process every frame with every classifier,
+    // hence the cascades must be loaded first.
+    if (m_captor.isReplaying())
+    {
+        for (auto& loader : m_loaders)
+        {
+            loader.join();
+        }
+        m_loaders.clear();
+    }
+
+    // Start up the fuser, if any.
+    if (m_fused)
+    {
+        m_fuser.start();
     }
 
     // Start up capture and display threads.
     m_captor.start();
-    m_displayer.start();
+    if (m_displayed)
+    {
+        m_displayer.start();
+    }
 
     // Start up the deallocator thread.
-    m_deallocator.setTrigger( m_classifiers.size() + 1 );
     m_deallocator.start();
+
+    // Start watching the configuration for changes.
+    m_watcher.start();
+
+    // Start publishing detection events.
+    if (m_events.isOpen())
+    {
+        m_events.start();
+    }
+
+    // Start serving control commands.
+    if (m_control.isOpen())
+    {
+        m_control.start();
+    }
+}
+
+
+void Detector::load()
+{
+    // Pull from the queue while there are classifiers to load.
+    Classifier* classifier;
+    m_load_queue.wait_and_pop(classifier);
+    while(classifier)
+    {
+        if(!classifier->load())
+        {
+            std::cout << "Warning: Failed to load classifier "
+                      << classifier->getFilename() << std::endl;
+        }
+        m_load_queue.wait_and_pop(classifier);
+    }
+}
+
+
+void Detector::startLoaders(const std::vector <Classifier*>& classifiers)
+{
+    for(auto classifier : classifiers)
+    {
+        m_load_queue.push(classifier);
+    }
+    unsigned loader_count = std::max(1u, std::thread::hardware_concurrency());
+    loader_count = std::min(loader_count, (unsigned)classifiers.size());
+    for(unsigned ii = 0; ii < loader_count; ++ii)
+    {
+        m_load_queue.push(NULL);
+        m_loaders.push_back(std::thread(&Detector::load, this));
+    }
+}
+
+
+std::vector <Classifier*> Detector::stopLoaders()
+{
+    // Take the classifiers off the queue, but not the NULLs
+    // terminating the loaders.
+    std::vector <Classifier*> unloaded;
+    size_t loaders = 0;
+    Classifier* classifier;
+    while (m_load_queue.try_pop(classifier))
+    {
+        if (classifier)
+        {
+            unloaded.push_back(classifier);
+        }
+        else
+        {
+            ++loaders;
+        }
+    }
+    for (size_t ii = 0; ii < loaders; ++ii)
+    {
+        m_load_queue.push(NULL);
+    }
+    for (auto& loader : m_loaders)
+    {
+        loader.join();
+    }
+    m_loaders.clear();
+    return unloaded;
 }
 
 
 Detector::~Detector()
 {
-    // Signal deallocator thread to stop.
-    m_done_queue.push(NULL);
+    // Stop watching the configuration.
+    m_watcher.stop();
+    m_watcher.join();
 
-    // Join all threads.
-    for (auto classifier : m_classifiers)
+    // Stop serving control commands (snapshots
+    // requested in the meantime time out.)
+    if (m_control.isOpen())
     {
-        classifier->join();
-        delete classifier;
+        m_control.stop();
+        m_control.join();
     }
+
+    // Wait for the cascades being loaded (not the others.)
+    stopLoaders();
+
+    // Join all threads (timing the teardown,
+    // once capture has ended.)
     m_captor.join();
-    m_displayer.join();
+    auto teardown = Pacer::now();
+    if (m_batched)
+    {
+        m_captor.removeOutput(m_batch_queue);
+        for (size_t ii = 0; ii < m_batches.size(); ++ii)
+        {
+            m_batch_queue.push(NULL);
+        }
+        for (auto& batch : m_batches)
+        {
+            batch->join();
+        }
+        std::cout << "Queue of batch: " << m_batch_queue.getCounters() << std::endl;
+    }
+    while (!m_classifiers.empty())
+    {
+        retireClassifier(m_classifiers.front()->getFilename());
+    }
+    if (m_displayed)
+    {
+        m_displayer.join();
+        std::cout << "Queue of display: " << m_display_queue.getCounters() << std::endl;
+    }
+
+    // Signal deallocator thread to stop, once all frames
+    // have been passed on (a replaying captor waits for
+    // every frame to be released.)
+    m_done_queue.push(NULL);
     m_deallocator.join();
 
-    for (auto cinput : m_classifier_inputs)
+    // Stop publishing detection events, once all are published.
+    if (m_events.isOpen())
+    {
+        m_events.stop();
+        m_events.join();
+    }
+
+    // Signal the fuser to stop, once all frames are released.
+    if (m_fused)
+    {
+        m_fusion_queue.push(NULL);
+        m_fuser.join();
+    }
+
+    // Return detections not displayed to the pool.
+    Detections* detections;
+    while (m_detections.try_pop(detections))
+    {
+        m_detections_pool.release(detections);
+    }
+    for (auto& stage : MatPool::instance().getCounters())
+    {
+        std::cout << "Matrix pool of " << stage.first << ": " << stage.second << std::endl;
+    }
+    for (auto& stage : PerfCounters::getTotals())
+    {
+        std::cout << "Performance counters of " << stage.first << ": "
+                  << stage.second << std::endl;
+    }
+
+    // Save the trace of the whole run.
+    if (!m_trace_fname.empty())
+    {
+        if (!Trace::isEnabled())
+        {
+            std::cout << "Warning: Tracing is not compiled in (build with trace=1)" << std::endl;
+        }
+        else if (!Trace::save(m_trace_fname))
+        {
+            std::cout << "Warning: Failed to save trace " << m_trace_fname << std::endl;
+        }
+        else
+        {
+            std::cout << "Saved trace to " << m_trace_fname << std::endl;
+        }
+    }
+
+    if (m_captor.isStopping())
     {
-        delete cinput;
+        std::cout << "Stopped in "
+                  << std::chrono::duration <double, std::milli> (Pacer::now() - teardown).count()
+                  << " msec" << std::endl;
     }
 }
 
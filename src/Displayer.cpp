@@ -6,39 +6,87 @@
 
 namespace sherlock {
 
+bool Displayer::snapshot(std::vector <uchar>& jpeg, const int& timeout_msec)
+{
+    std::unique_lock <std::mutex> locker (m_snapshot_mutex);
+    auto count = m_snapshot_count;
+    ++m_snapshot_requests;
+    bool taken = m_snapshot_taken.wait_for(
+        locker,
+        std::chrono::milliseconds(timeout_msec),
+        [this, count]() { return m_snapshot_count != count; });
+    --m_snapshot_requests;
+    if (taken)
+    {
+        jpeg = m_snapshot;
+    }
+    return taken;
+}
+
 // Draw rectangles on queued frames, and display.
 void Displayer::run ()
 {
-    // Create the output window.
+    applyPlacement("display", m_placement);
+    Trace::setThreadName("display");
+    PerfCounters::attach("display");
+    MatPool::setStage("display");
+
+    // Create the output window (if any.)
     const char* title = "Sherlock";
-    cv::namedWindow(title, CV_WINDOW_NORMAL);
+    if (m_window)
+    {
+        cv::namedWindow(title, CV_WINDOW_NORMAL);
+    }
 
     // Monitor framerates for the given seconds past.
     bites::RateTicker ticker ({ 1, 5, 10 });
 
+    // Detections and text are kept in an overlay, composited
+    // with each frame into the canvas (frames are only read, as
+    // classifiers may still be reading them too.)
+    Overlay overlay;
+    cv::Mat canvas;
+    MatPool::attach(canvas);
+
     // Pull from the queue while there are valid matrices.
     cv::Mat* frame;
-    m_display_queue.wait_and_pop(frame);
+    float reduced;
+    m_display_queue.wait_and_pop(frame, reduced);
     while(frame)
     {
-        // Draw the rectangles.
-        Classifier::RectColor rect_color;
-        while(m_rect_colors.try_pop(rect_color))
+        // Update the overlay, a batch at a time.
+        Detections* detections;
+        while(m_detections.try_pop(detections))
+        {
+            overlay.update(*detections);
+            m_pool.release(detections);
+        }
+
+        // Without a window, frames are composited
+        // only for snapshots requested.
+        bool snapshot = m_snapshot_requests > 0;
+        if (!m_window && !snapshot)
+        {
+            ticker.tick();
+            PerfCounters::frameDone();
+            m_done_queue.push(frame);
+            m_display_queue.wait_and_pop(frame, reduced);
+            continue;
+        }
+
+        // Composite at a reduced size while the display is overloaded,
+        // and at most at the maximum width.
+        const cv::Mat& image = *frame;
+        double scale = reduced;
+        if(m_max_width > 0 && image.cols*scale > m_max_width)
         {
-            auto rect = rect_color.rect;
-            auto color = rect_color.color;
-            cv::rectangle(
-                *frame,
-                cv::Point(rect.x, rect.y),
-                cv::Point(rect.x + rect.width, rect.y + rect.height),
-                color,
-                2  // thickness.                
-                );
+            scale = (double)m_max_width / image.cols;
         }
+        cv::Size size = Pyramid::reducedSize(image.size(), scale);
 
-        // Write the on-screen-display information.
+        // Assemble the on-screen-display information.
         std::ostringstream line1, line2, line3;
-        line1 << frame->cols << "x" << frame->rows;
+        line1 << image.cols << "x" << image.rows;
         line2 << std::fixed << std::setprecision(2);
         auto fps = m_get_capture_fps();
         line2 << fps[0] << ", " << fps[1] << ", " << fps[2] << " (FPS capture)";
@@ -46,29 +94,39 @@ void Displayer::run ()
         line3 << std::fixed << std::setprecision(2);
         line3 << fps[0] << ", " << fps[1] << ", " << fps[2] << " (FPS display)";
         std::list<std::string> lines ({ line1.str(), line2.str(), line3.str() });
-        sherlock::writeOSD(*frame, lines, 0.04);
+        {
+            Span span ("draw");
+            span.setFrame(frame);
+            overlay.render(image, size, m_palette, lines, canvas);
+        }
 
         // Display the snapshot.
-        cv::imshow(title, *frame); 
-        cv::waitKey(1);
-        
-        // Filter out excess images in the queue.
-        // If display hardware is not fast enough, showing these 
-        // images introduces (incremental) lag, hence the "lossy filter."
-        // Add all dropped and processed frames to "done" queue.
-        int count = 0;
-        auto prev_frame = frame;
-        while(m_display_queue.try_pop(frame))
+        if (m_window)
         {
-            m_done_queue.push(prev_frame);
-            prev_frame = frame;
-            ++count;
+            Span span ("imshow");
+            span.setFrame(frame);
+            cv::imshow(title, canvas); 
+            cv::waitKey(1);
         }
-        if(count == 0)
+
+        // Hand the annotated frame to snapshot requests.
+        if (snapshot)
         {
-            m_done_queue.push(prev_frame);
-            m_display_queue.wait_and_pop(frame);
+            std::vector <uchar> jpeg;
+            cv::imencode(".jpg", canvas, jpeg);
+            std::lock_guard <std::mutex> locker (m_snapshot_mutex);
+            m_snapshot.swap(jpeg);
+            ++m_snapshot_count;
+            m_snapshot_taken.notify_all();
         }
+        
+        // Pass on the displayed frame, and retrieve the next.
+        // If display hardware is not fast enough, showing every
+        // image introduces (incremental) lag, hence excess frames
+        // are dropped by the display queue's overload policy.
+        PerfCounters::frameDone();
+        m_done_queue.push(frame);
+        m_display_queue.wait_and_pop(frame, reduced);
     }
 }
 
@@ -0,0 +1,68 @@
+/**
+   Pipeline edge overload policies.
+*/
+
+// Include standard headers.
+#include <sstream>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+bool parseEdgePolicy(const std::string& spec, EdgePolicy& policy)
+{
+    std::istringstream tokens (spec);
+    std::string kind;
+    if (!(tokens >> kind))
+    {
+        return false;
+    }
+    EdgePolicy parsed;
+    if (kind == "block") parsed.kind = EdgePolicy::BLOCK;
+    else if (kind == "drop_oldest") parsed.kind = EdgePolicy::DROP_OLDEST;
+    else if (kind == "drop_newest") parsed.kind = EdgePolicy::DROP_NEWEST;
+    else if (kind == "decimate") parsed.kind = EdgePolicy::DECIMATE;
+    else if (kind == "reduce") parsed.kind = EdgePolicy::REDUCE;
+    else return false;
+
+    // Decimation and reduction take their argument first.
+    if (parsed.kind == EdgePolicy::DECIMATE
+        && (!(tokens >> parsed.decimation) || parsed.decimation < 1))
+    {
+        return false;
+    }
+    if (parsed.kind == EdgePolicy::REDUCE
+        && (!(tokens >> parsed.scale) || parsed.scale <= 0 || parsed.scale > 1))
+    {
+        return false;
+    }
+    if (tokens >> parsed.capacity)
+    {
+        if (parsed.capacity < 1)
+        {
+            return false;
+        }
+    }
+    else if (!tokens.eof())
+    {
+        return false;
+    }
+    policy = parsed;
+    return true;
+}
+
+
+std::ostream& operator<<(std::ostream& out, const EdgeCounters& counters)
+{
+    return out << counters.pushed << " pushed, "
+               << counters.delivered << " delivered, "
+               << counters.dropped_oldest << " dropped (oldest), "
+               << counters.dropped_newest << " dropped (newest), "
+               << counters.decimated << " decimated, "
+               << counters.blocked << " blocked, "
+               << counters.reduced << " reduced, "
+               << counters.discarded << " discarded";
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,643 @@
+/**
+   The Evaluator class implements native cascade evaluation.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <cmath>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Relative difference for grouping rectangles (same as OpenCV.)
+const double GROUP_EPS = 0.2;
+
+// Sum of rectangle with corner offsets *o* in integral *p*,
+// for window at offset *b* (in the same order as OpenCV's CALC_SUM.)
+template <typename T>
+inline T rectSum(const T* p, const int* o, const int& b)
+{
+    return p[b + o[0]] - p[b + o[1]] - p[b + o[2]] + p[b + o[3]];
+}
+
+// Unnormalized value of Haar feature with corner offsets *o*
+// and weights *w*, for window at offset *b*.
+inline float haarValue(const int* p, const int* o, const float* w, const int& b)
+{
+    float value = w[0] * rectSum(p, o, b) + w[1] * rectSum(p, o + 4, b);
+    if (w[2] != 0.0f)
+    {
+        value += w[2] * rectSum(p, o + 8, b);
+    }
+    return value;
+}
+
+// Sum of LBP grid cell with corners *i0*, *i1*, *i2*, *i3*.
+inline int lbpCell(const int* p, const int* o, const int& b,
+                   int i0, int i1, int i2, int i3)
+{
+    return p[b + o[i0]] - p[b + o[i1]] - p[b + o[i2]] + p[b + o[i3]];
+}
+
+// LBP code of feature with (4x4 grid) corner offsets *o*,
+// for window at offset *b*.
+inline int lbpCode(const int* p, const int* o, const int& b)
+{
+    int center = lbpCell(p, o, b, 5, 6, 9, 10);
+    return (lbpCell(p, o, b, 0, 1, 4, 5) >= center ? 128 : 0) |
+           (lbpCell(p, o, b, 1, 2, 5, 6) >= center ? 64 : 0) |
+           (lbpCell(p, o, b, 2, 3, 6, 7) >= center ? 32 : 0) |
+           (lbpCell(p, o, b, 6, 7, 10, 11) >= center ? 16 : 0) |
+           (lbpCell(p, o, b, 10, 11, 14, 15) >= center ? 8 : 0) |
+           (lbpCell(p, o, b, 9, 10, 13, 14) >= center ? 4 : 0) |
+           (lbpCell(p, o, b, 8, 9, 12, 13) >= center ? 2 : 0) |
+           (lbpCell(p, o, b, 4, 5, 8, 9) >= center ? 1 : 0);
+}
+
+// Return true if LBP code *c* is in the category subset.
+inline bool inSubset(const int32_t* subset, const int& c)
+{
+    return (subset[c >> 5] & (1 << (c & 31))) != 0;
+}
+
+// Move window *from* into slot *to* of the group.
+inline void moveWindow(Evaluator::Windows& windows, const int& from, const int& to)
+{
+    windows.x[to] = windows.x[from];
+    windows.base[to] = windows.base[from];
+    windows.sq_base[to] = windows.sq_base[from];
+    windows.inv_norm[to] = windows.inv_norm[from];
+    windows.sums[to] = windows.sums[from];
+}
+
+}  // namespace.
+
+
+void Evaluator::detectMultiScale(
+    Pyramid& pyramid,
+    std::vector <cv::Rect>& objects,
+    const int& min_neighbors,
+    const cv::Size& min_size,
+    cv::Size max_size)
+{
+    objects.clear();
+    if (m_cascade.empty())
+    {
+        return;
+    }
+    if (max_size.height == 0 || max_size.width == 0)
+    {
+        max_size = pyramid.getFrameSize();
+    }
+    startScan(pyramid, min_size, max_size);
+
+    // Scan the levels, with the same stopping (and skipping)
+    // conditions as cv::CascadeClassifier::detectMultiScale.
+    auto window = m_cascade.windowSize();
+    for (int level = 0; level < pyramid.getLevelCount(); ++level)
+    {
+        double factor = pyramid.getFactor(level);
+        cv::Size window_size (
+            cvRound(window.width * factor),
+            cvRound(window.height * factor));
+        cv::Size size = pyramid.getSize(level);
+        if (size.width - window.width <= 0 || size.height - window.height <= 0)
+        {
+            break;
+        }
+        if (window_size.width > max_size.width || window_size.height > max_size.height)
+        {
+            break;
+        }
+        if (window_size.width < min_size.width || window_size.height < min_size.height)
+        {
+            continue;
+        }
+        detectSingleScale(pyramid, level, objects);
+    }
+    m_tiles.merge(objects);
+    cv::groupRectangles(objects, min_neighbors, GROUP_EPS);
+}
+
+
+bool Evaluator::detectSingleScale(
+    Pyramid& pyramid,
+    const int& level,
+    std::vector <cv::Rect>& candidates)
+{
+    if (m_cascade.empty() || !setLevel(pyramid, level))
+    {
+        return false;
+    }
+    auto window = m_cascade.windowSize();
+    auto size = pyramid.getSize(level);
+    double factor = pyramid.getFactor(level);
+    cv::Size window_size (
+        cvRound(window.width * factor),
+        cvRound(window.height * factor));
+    cv::Size processing (size.width - window.width, size.height - window.height);
+    const int step = factor > 2. ? 1 : 2;
+
+    Windows windows;
+    for (int y = 0; y < processing.height; y += step)
+    {
+        if (!isRowScanned(y, factor, window_size))
+        {
+            continue;
+        }
+        int skip = -1;
+        for (int x = 0; x < processing.width; )
+        {
+            // Group the next positions of the row (to be scanned.)
+            windows.count = 0;
+            for (; x < processing.width && windows.count < LANES; x += step)
+            {
+                if (isScanned(x, y, factor, window_size))
+                {
+                    windows.x[windows.count++] = x;
+                }
+            }
+            if (windows.count == 0)
+            {
+                continue;
+            }
+            setWindows(windows, y);
+
+            evalFirstStage(windows, skip, step);
+            evalRemainingStages(windows);
+            for (int ii = 0; ii < windows.count; ++ii)
+            {
+                candidates.push_back(cv::Rect(
+                    cvRound(windows.x[ii] * factor),
+                    cvRound(y * factor),
+                    window_size.width,
+                    window_size.height));
+            }
+        }
+    }
+    return true;
+}
+
+
+void Evaluator::detectBatch(
+    Pyramid& pyramid,
+    const std::vector <Evaluator*>& evaluators,
+    const std::vector <Limits>& limits,
+    std::vector <std::vector <cv::Rect>>& objects)
+{
+    const int count = evaluators.size();
+    objects.assign(count, std::vector <cv::Rect> ());
+
+    // Evaluators still scanning levels; each one stops (or skips
+    // levels) under the same conditions as in detectMultiScale.
+    std::vector <char> scanning (count);
+    std::vector <cv::Size> max_sizes (count);
+    for (int ii = 0; ii < count; ++ii)
+    {
+        scanning[ii] = !evaluators[ii]->m_cascade.empty();
+        max_sizes[ii] = limits[ii].max_size;
+        if (max_sizes[ii].height == 0 || max_sizes[ii].width == 0)
+        {
+            max_sizes[ii] = pyramid.getFrameSize();
+        }
+        if (scanning[ii])
+        {
+            evaluators[ii]->startScan(pyramid, limits[ii].min_size, max_sizes[ii]);
+        }
+    }
+
+    // Per-evaluator state of the sweep at the current level.
+    std::vector <int> active;
+    std::vector <cv::Size> window_sizes (count);
+    std::vector <cv::Size> processing (count);
+    std::vector <int> skip (count);
+    std::vector <char> row_scanned (count);
+    std::vector <Windows> windows (count);
+
+    for (int level = 0; level < pyramid.getLevelCount(); ++level)
+    {
+        double factor = pyramid.getFactor(level);
+        cv::Size size = pyramid.getSize(level);
+        active.clear();
+        int remaining = 0;
+        cv::Size sweep (0, 0);
+        for (int ii = 0; ii < count; ++ii)
+        {
+            if (!scanning[ii])
+            {
+                continue;
+            }
+            auto window = evaluators[ii]->m_cascade.windowSize();
+            window_sizes[ii] = cv::Size(
+                cvRound(window.width * factor),
+                cvRound(window.height * factor));
+            processing[ii] = cv::Size(size.width - window.width, size.height - window.height);
+            if (processing[ii].width <= 0 || processing[ii].height <= 0 ||
+                window_sizes[ii].width > max_sizes[ii].width ||
+                window_sizes[ii].height > max_sizes[ii].height)
+            {
+                scanning[ii] = false;
+                continue;
+            }
+            ++remaining;
+            if (window_sizes[ii].width < limits[ii].min_size.width ||
+                window_sizes[ii].height < limits[ii].min_size.height)
+            {
+                continue;
+            }
+            evaluators[ii]->setLevel(pyramid, level);
+            active.push_back(ii);
+            sweep.width = std::max(sweep.width, processing[ii].width);
+            sweep.height = std::max(sweep.height, processing[ii].height);
+        }
+        if (remaining == 0)
+        {
+            break;
+        }
+
+        // Sweep the union of the evaluators' processing areas once,
+        // a group of positions at a time: the first stage of every
+        // evaluator is run on the group (while its data is in cache)
+        // before any evaluator descends into its remaining stages.
+        const int step = factor > 2. ? 1 : 2;
+        for (int y = 0; y < sweep.height; y += step)
+        {
+            for (auto ii : active)
+            {
+                skip[ii] = -1;
+                row_scanned[ii] = evaluators[ii]->isRowScanned(y, factor, window_sizes[ii]);
+            }
+            for (int x0 = 0; x0 < sweep.width; x0 += LANES * step)
+            {
+                for (auto ii : active)
+                {
+                    auto& group = windows[ii];
+                    group.count = 0;
+                    if (y >= processing[ii].height || !row_scanned[ii])
+                    {
+                        continue;
+                    }
+                    auto evaluator = evaluators[ii];
+                    for (int x = x0; x < processing[ii].width && group.count < LANES; x += step)
+                    {
+                        if (evaluator->isScanned(x, y, factor, window_sizes[ii]))
+                        {
+                            group.x[group.count++] = x;
+                        }
+                    }
+                    if (group.count == 0)
+                    {
+                        continue;
+                    }
+                    evaluator->setWindows(group, y);
+                    evaluator->evalFirstStage(group, skip[ii], step);
+                }
+                for (auto ii : active)
+                {
+                    auto& group = windows[ii];
+                    evaluators[ii]->evalRemainingStages(group);
+                    for (int jj = 0; jj < group.count; ++jj)
+                    {
+                        objects[ii].push_back(cv::Rect(
+                            cvRound(group.x[jj] * factor),
+                            cvRound(y * factor),
+                            window_sizes[ii].width,
+                            window_sizes[ii].height));
+                    }
+                }
+            }
+        }
+    }
+    for (int ii = 0; ii < count; ++ii)
+    {
+        if (!evaluators[ii]->m_cascade.empty())
+        {
+            evaluators[ii]->m_tiles.merge(objects[ii]);
+        }
+        cv::groupRectangles(objects[ii], limits[ii].min_neighbors, GROUP_EPS);
+    }
+}
+
+
+void Evaluator::evalFirstStage(Windows& windows, int& skip, const int& step) const
+{
+    // A sequential scan skips the position right after one
+    // rejected by the first stage; the same positions are
+    // skipped here (possibly across groups.)
+    const float threshold = m_cascade.stageThreshold()[0];
+    evalStage(0, windows);
+    int kept = 0;
+    for (int ii = 0; ii < windows.count; ++ii)
+    {
+        if (windows.x[ii] == skip)
+        {
+            continue;
+        }
+        if (windows.sums[ii] < threshold)
+        {
+            skip = windows.x[ii] + step;
+            continue;
+        }
+        moveWindow(windows, ii, kept++);
+    }
+    windows.count = kept;
+}
+
+
+void Evaluator::evalRemainingStages(Windows& windows) const
+{
+    const int stage_count = m_cascade.stageCount();
+    for (int stage = 1; stage < stage_count && windows.count; ++stage)
+    {
+        evalStage(stage, windows);
+        rejectWindows(stage, windows);
+    }
+}
+
+
+void Evaluator::startScan(
+    Pyramid& pyramid,
+    const cv::Size& min_size,
+    const cv::Size& max_size)
+{
+    if (m_tiles.isEnabled() && pyramid.getLevelCount() > 0)
+    {
+        m_tiles.update(pyramid.getImage(0), {
+                pyramid.getScaleFactor(),
+                (double)min_size.width, (double)min_size.height,
+                (double)max_size.width, (double)max_size.height });
+    }
+
+    // Render the exclusion mask at the size of the frame (anew,
+    // as the size changes), noting the rows excluded throughout.
+    if (!m_exclusion || m_excluded.size() == pyramid.getFrameSize())
+    {
+        return;
+    }
+    m_exclusion->render(pyramid.getFrameSize(), m_excluded);
+    m_excluded_rows.resize(m_excluded.rows);
+    for (int row = 0; row < m_excluded.rows; ++row)
+    {
+        m_excluded_rows[row] = cv::countNonZero(m_excluded.row(row)) == m_excluded.cols;
+    }
+}
+
+
+void Evaluator::setExclusion(const std::shared_ptr <const ExclusionMask>& mask)
+{
+    std::shared_ptr <const ExclusionMask> exclusion;
+    if (mask && !mask->empty())
+    {
+        exclusion = mask;
+    }
+    if (exclusion == m_exclusion)
+    {
+        return;
+    }
+    m_exclusion = exclusion;
+    m_excluded.release();
+    m_excluded_rows.clear();
+
+    // Candidates cached were found with the previous mask.
+    m_tiles.reset();
+}
+
+
+bool Evaluator::setLevel(Pyramid& pyramid, const int& level)
+{
+    auto window = m_cascade.windowSize();
+    auto size = pyramid.getSize(level);
+    if (size.width - window.width <= 0 || size.height - window.height <= 0)
+    {
+        return false;
+    }
+
+    const cv::Mat& sum = pyramid.getSum(level);
+    m_sum = sum.ptr<int>();
+    m_tilted = m_sum;
+    if (m_cascade.featureType() == Cascade::HAAR)
+    {
+        // Variance normalization rectangle is the window less its border.
+        const cv::Mat& sqsum = pyramid.getSquaredSum(level);
+        m_sqsum = sqsum.ptr<double>();
+        m_sq_stride = sqsum.step / sizeof(double);
+        const int stride = sum.step / sizeof(int);
+        const int x0 = 1, y0 = 1;
+        const int x1 = window.width - 1, y1 = window.height - 1;
+        m_norm[0] = y0 * stride + x0;
+        m_norm[1] = y0 * stride + x1;
+        m_norm[2] = y1 * stride + x0;
+        m_norm[3] = y1 * stride + x1;
+        m_sq_norm[0] = y0 * m_sq_stride + x0;
+        m_sq_norm[1] = y0 * m_sq_stride + x1;
+        m_sq_norm[2] = y1 * m_sq_stride + x0;
+        m_sq_norm[3] = y1 * m_sq_stride + x1;
+        m_norm_area = (double)(x1 - x0) * (y1 - y0);
+        if (m_cascade.hasTilted())
+        {
+            m_tilted = pyramid.getTilted(level).ptr<int>();
+        }
+    }
+    if ((int)(sum.step / sizeof(int)) != m_stride)
+    {
+        setStride(sum.step / sizeof(int));
+    }
+    return true;
+}
+
+
+void Evaluator::setStride(const int& stride)
+{
+    const int count = m_cascade.featureCount();
+    const int32_t* rects = m_cascade.featureRects();
+    if (m_cascade.featureType() == Cascade::HAAR)
+    {
+        // Corners of each rectangle slot, upright or rotated by 45 degrees.
+        m_offsets.resize(count * 12);
+        m_is_tilted.resize(count);
+        for (int ff = 0; ff < count; ++ff)
+        {
+            const bool tilted = m_cascade.featureTilted()[ff] != 0;
+            m_is_tilted[ff] = tilted;
+            for (int slot = 0; slot < 3; ++slot)
+            {
+                const int32_t* r = rects + ff*12 + slot*4;
+                const int x = r[0], y = r[1], w = r[2], h = r[3];
+                int* o = &m_offsets[ff*12 + slot*4];
+                if (tilted)
+                {
+                    o[0] = y * stride + x;
+                    o[1] = (y + h) * stride + (x - h);
+                    o[2] = (y + w) * stride + (x + w);
+                    o[3] = (y + w + h) * stride + (x + w - h);
+                }
+                else
+                {
+                    o[0] = y * stride + x;
+                    o[1] = y * stride + (x + w);
+                    o[2] = (y + h) * stride + x;
+                    o[3] = (y + h) * stride + (x + w);
+                }
+            }
+        }
+    }
+    else
+    {
+        // Corners of the 3x3 grid of cells, row by row.
+        m_offsets.resize(count * 16);
+        for (int ff = 0; ff < count; ++ff)
+        {
+            const int32_t* r = rects + ff*12;
+            int* o = &m_offsets[ff*16];
+            for (int row = 0; row < 4; ++row)
+            {
+                for (int col = 0; col < 4; ++col)
+                {
+                    o[row*4 + col] = (r[1] + row*r[3]) * stride + (r[0] + col*r[2]);
+                }
+            }
+        }
+    }
+    m_stride = stride;
+}
+
+
+void Evaluator::setWindows(Windows& windows, const int& y) const
+{
+    for (int ii = 0; ii < windows.count; ++ii)
+    {
+        windows.base[ii] = y * m_stride + windows.x[ii];
+    }
+    if (m_cascade.featureType() != Cascade::HAAR)
+    {
+        return;
+    }
+    for (int ii = 0; ii < windows.count; ++ii)
+    {
+        windows.sq_base[ii] = y * m_sq_stride + windows.x[ii];
+        double valsum = rectSum(m_sum, m_norm, windows.base[ii]);
+        double valsqsum = rectSum(m_sqsum, m_sq_norm, windows.sq_base[ii]);
+        double norm = m_norm_area * valsqsum - valsum * valsum;
+        norm = norm > 0. ? std::sqrt(norm) : 1.;
+        windows.inv_norm[ii] = 1. / norm;
+    }
+}
+
+
+void Evaluator::evalStage(const int& stage, Windows& windows) const
+{
+    const int count = windows.count;
+    double* sums = windows.sums;
+    for (int ii = 0; ii < count; ++ii)
+    {
+        sums[ii] = 0.;
+    }
+
+    const int first = m_cascade.stageFirstTree()[stage];
+    const int last = first + m_cascade.stageTreeCount()[stage];
+    const int32_t* first_node = m_cascade.treeFirstNode();
+    const int32_t* first_leaf = m_cascade.treeFirstLeaf();
+    const int32_t* features = m_cascade.nodeFeature();
+    const float* thresholds = m_cascade.nodeThreshold();
+    const int32_t* lefts = m_cascade.nodeLeft();
+    const int32_t* rights = m_cascade.nodeRight();
+    const float* leaves = m_cascade.leafValue();
+    const int* base = windows.base;
+
+    if (m_cascade.featureType() == Cascade::HAAR)
+    {
+        const float* weights = m_cascade.featureWeights();
+        const double* inv_norm = windows.inv_norm;
+        for (int tree = first; tree < last; ++tree)
+        {
+            const int root = first_node[tree];
+            const float* leaf = leaves + first_leaf[tree];
+            if (m_cascade.isStump())
+            {
+                // Fetch the stump once, and apply it to all windows.
+                const int ff = features[root];
+                const int* p = m_is_tilted[ff] ? m_tilted : m_sum;
+                const int* o = &m_offsets[ff*12];
+                const float* w = weights + ff*3;
+                const float threshold = thresholds[root];
+                const float leaf_lt = leaf[-lefts[root]];
+                const float leaf_ge = leaf[-rights[root]];
+                for (int ii = 0; ii < count; ++ii)
+                {
+                    double value = haarValue(p, o, w, base[ii]) * inv_norm[ii];
+                    sums[ii] += value < threshold ? leaf_lt : leaf_ge;
+                }
+                continue;
+            }
+            for (int ii = 0; ii < count; ++ii)
+            {
+                int idx = 0;
+                do
+                {
+                    const int node = root + idx;
+                    const int ff = features[node];
+                    const int* p = m_is_tilted[ff] ? m_tilted : m_sum;
+                    double value = haarValue(
+                        p, &m_offsets[ff*12], weights + ff*3, base[ii]) * inv_norm[ii];
+                    idx = value < thresholds[node] ? lefts[node] : rights[node];
+                } while (idx > 0);
+                sums[ii] += leaf[-idx];
+            }
+        }
+        return;
+    }
+
+    const int subset_size = m_cascade.subsetSize();
+    const int32_t* subsets = m_cascade.nodeSubset();
+    for (int tree = first; tree < last; ++tree)
+    {
+        const int root = first_node[tree];
+        const float* leaf = leaves + first_leaf[tree];
+        if (m_cascade.isStump())
+        {
+            const int* o = &m_offsets[features[root]*16];
+            const int32_t* subset = subsets + root*subset_size;
+            const float leaf_in = leaf[-lefts[root]];
+            const float leaf_out = leaf[-rights[root]];
+            for (int ii = 0; ii < count; ++ii)
+            {
+                int code = lbpCode(m_sum, o, base[ii]);
+                sums[ii] += inSubset(subset, code) ? leaf_in : leaf_out;
+            }
+            continue;
+        }
+        for (int ii = 0; ii < count; ++ii)
+        {
+            int idx = 0;
+            do
+            {
+                const int node = root + idx;
+                int code = lbpCode(m_sum, &m_offsets[features[node]*16], base[ii]);
+                idx = inSubset(subsets + node*subset_size, code) ?
+                    lefts[node] : rights[node];
+            } while (idx > 0);
+            sums[ii] += leaf[-idx];
+        }
+    }
+}
+
+
+void Evaluator::rejectWindows(const int& stage, Windows& windows) const
+{
+    const float threshold = m_cascade.stageThreshold()[stage];
+    int kept = 0;
+    for (int ii = 0; ii < windows.count; ++ii)
+    {
+        if (!(windows.sums[ii] < threshold))
+        {
+            moveWindow(windows, ii, kept++);
+        }
+    }
+    windows.count = kept;
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,435 @@
+/**
+   The EventStream class implements streaming of detection events.
+*/
+
+// Include standard headers.
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// Include system headers.
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Include 3rd party headers.
+#include <boost/filesystem.hpp>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Time (in milliseconds) events are collected before sending a batch.
+const int BATCH_MSEC = 20;
+
+// Maximum number of bytes queued for a subscriber,
+// beyond which the subscriber is disconnected.
+const size_t MAX_BUFFER = 1 << 20;
+
+// Maximum number of subscribers connected at once.
+const size_t MAX_SUBSCRIBERS = 16;
+
+// Resolve a socket address (see EventStream::open.)
+bool resolve(
+    const std::string& address,
+    struct sockaddr_storage& storage,
+    socklen_t& length)
+{
+    memset(&storage, 0, sizeof(storage));
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+        auto path = address.substr(5);
+        auto local = reinterpret_cast <struct sockaddr_un*> (&storage);
+        if (path.empty() || path.size() >= sizeof(local->sun_path))
+        {
+            return false;
+        }
+        local->sun_family = AF_UNIX;
+        strncpy(local->sun_path, path.c_str(), sizeof(local->sun_path) - 1);
+        length = sizeof(struct sockaddr_un);
+        return true;
+    }
+    if (address.compare(0, 4, "tcp:") == 0)
+    {
+        auto rest = address.substr(4);
+        auto colon = rest.rfind(':');
+        std::string host = colon == std::string::npos ? "127.0.0.1" : rest.substr(0, colon);
+        std::string port = colon == std::string::npos ? rest : rest.substr(colon + 1);
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* found;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0)
+        {
+            return false;
+        }
+        memcpy(&storage, found->ai_addr, found->ai_addrlen);
+        length = found->ai_addrlen;
+        freeaddrinfo(found);
+        return true;
+    }
+    return false;
+}
+
+// Append a little-endian integer.
+template <typename T>
+void put(std::string& out, T value)
+{
+    for (size_t ii = 0; ii < sizeof(T); ++ii)
+    {
+        out.push_back((char)((uint64_t)value >> (8 * ii)));
+    }
+}
+
+// Read a little-endian integer.
+template <typename T>
+T get(const char* data)
+{
+    uint64_t value = 0;
+    for (size_t ii = 0; ii < sizeof(T); ++ii)
+    {
+        value |= (uint64_t)(unsigned char)data[ii] << (8 * ii);
+    }
+    return (T)value;
+}
+
+// Escape a string for JSON.
+std::string escape(const std::string& text)
+{
+    std::string escaped;
+    for (auto ch : text)
+    {
+        if (ch == '"' || ch == '\\')
+        {
+            escaped.push_back('\\');
+        }
+        if ((unsigned char)ch >= 0x20)
+        {
+            escaped.push_back(ch);
+        }
+    }
+    return escaped;
+}
+
+}  // namespace.
+
+
+EventStream::EventStream() :
+    m_format    (JSON),
+    m_listen_fd (-1),
+    m_stop_fd   (eventfd(0, EFD_CLOEXEC)),
+    m_subscribers (0),
+    m_count     (0)
+{/* Empty. */}
+
+
+EventStream::~EventStream()
+{
+    if (m_listen_fd >= 0)
+    {
+        close(m_listen_fd);
+        if (!m_path.empty())
+        {
+            unlink(m_path.c_str());
+        }
+    }
+    if (m_stop_fd >= 0)
+    {
+        close(m_stop_fd);
+    }
+}
+
+
+bool EventStream::open(const std::string& address, const Format& format)
+{
+    struct sockaddr_storage storage;
+    socklen_t length;
+    if (!resolve(address, storage, length))
+    {
+        return false;
+    }
+    int fd = socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    std::string path;
+    if (storage.ss_family == AF_UNIX)
+    {
+        path = reinterpret_cast <struct sockaddr_un*> (&storage)->sun_path;
+        unlink(path.c_str());
+    }
+    else
+    {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (bind(fd, (struct sockaddr*)&storage, length) < 0
+        || listen(fd, MAX_SUBSCRIBERS) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_format = format;
+    m_path = path;
+    m_listen_fd = fd;
+    return true;
+}
+
+
+void EventStream::capture(const cv::Mat* frame, const boost::posix_time::ptime& tstamp)
+{
+    static const boost::posix_time::ptime epoch (boost::gregorian::date(1970, 1, 1));
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_frames[frame] = { m_count++, (tstamp - epoch).total_microseconds() };
+}
+
+
+void EventStream::publish(
+    const cv::Mat* frame,
+    const std::string& classifier,
+    const std::vector <cv::Rect>& rects)
+{
+    if (rects.empty() || m_subscribers == 0)
+    {
+        return;
+    }
+    auto name = boost::filesystem::path(classifier).stem().string();
+    std::lock_guard <std::mutex> locker (m_mutex);
+    auto entry = m_frames.find(frame);
+    if (entry == m_frames.end())
+    {
+        return;
+    }
+    for (auto& rect : rects)
+    {
+        encode({ entry->second.first, entry->second.second, name, rect },
+               m_format, m_pending);
+    }
+}
+
+
+void EventStream::release(const cv::Mat* frame)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_frames.erase(frame);
+}
+
+
+void EventStream::stop()
+{
+    uint64_t one = 1;
+    if (m_stop_fd >= 0 && write(m_stop_fd, &one, sizeof(one)) < 0)
+    {
+        std::cout << "Warning: Failed to stop event stream" << std::endl;
+    }
+}
+
+
+void EventStream::encode(const Event& event, const Format& format, std::string& out)
+{
+    if (format == JSON)
+    {
+        std::ostringstream line;
+        line << "{\"frame\":" << event.frame
+             << ",\"time\":" << event.time
+             << ",\"classifier\":\"" << escape(event.classifier) << "\""
+             << ",\"x\":" << event.rect.x
+             << ",\"y\":" << event.rect.y
+             << ",\"width\":" << event.rect.width
+             << ",\"height\":" << event.rect.height << "}\n";
+        out += line.str();
+        return;
+    }
+    auto name = event.classifier.substr(0, 255);
+    put <uint32_t> (out, 8 + 8 + 4 * 2 + 1 + name.size());
+    put <int64_t> (out, event.frame);
+    put <int64_t> (out, event.time);
+    put <int16_t> (out, cv::saturate_cast <int16_t> (event.rect.x));
+    put <int16_t> (out, cv::saturate_cast <int16_t> (event.rect.y));
+    put <int16_t> (out, cv::saturate_cast <int16_t> (event.rect.width));
+    put <int16_t> (out, cv::saturate_cast <int16_t> (event.rect.height));
+    put <uint8_t> (out, name.size());
+    out += name;
+}
+
+
+size_t EventStream::decode(const char* data, const size_t& size, Event& event)
+{
+    const size_t fixed = 8 + 8 + 4 * 2 + 1;
+    if (size < 4)
+    {
+        return 0;
+    }
+    size_t length = get <uint32_t> (data);
+    if (size < 4 + length || length < fixed)
+    {
+        return 0;
+    }
+    data += 4;
+    event.frame = get <int64_t> (data);
+    event.time = get <int64_t> (data + 8);
+    event.rect = cv::Rect(
+        get <int16_t> (data + 16), get <int16_t> (data + 18),
+        get <int16_t> (data + 20), get <int16_t> (data + 22));
+    size_t name_length = std::min <size_t> (get <uint8_t> (data + 24), length - fixed);
+    event.classifier.assign(data + fixed, name_length);
+    return 4 + length;
+}
+
+
+int EventStream::connect(const std::string& address)
+{
+    struct sockaddr_storage storage;
+    socklen_t length;
+    if (!resolve(address, storage, length))
+    {
+        return -1;
+    }
+    int fd = socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && ::connect(fd, (struct sockaddr*)&storage, length) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+void EventStream::run()
+{
+    if (m_listen_fd < 0 || m_stop_fd < 0)
+    {
+        return;
+    }
+
+    // Connected subscribers, with the data queued for them.
+    std::map <int, std::string> subscribers;
+    long dropped = 0;
+    while (true)
+    {
+        std::vector <struct pollfd> fds = {
+            { m_stop_fd, POLLIN, 0 },
+            { m_listen_fd, POLLIN, 0 },
+        };
+        for (auto& subscriber : subscribers)
+        {
+            fds.push_back({
+                subscriber.first,
+                (short)(subscriber.second.empty() ? POLLIN : POLLIN | POLLOUT),
+                0 });
+        }
+        int count = poll(fds.data(), fds.size(), BATCH_MSEC);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0 || fds[0].revents)
+        {
+            break;
+        }
+
+        // Accept a new subscriber (unless too many are connected.)
+        if (fds[1].revents & POLLIN)
+        {
+            int fd = accept4(m_listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0 && subscribers.size() < MAX_SUBSCRIBERS)
+            {
+                subscribers[fd];
+                m_subscribers = subscribers.size();
+            }
+            else if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+
+        // Queue the batch of events pending for every subscriber.
+        std::string batch;
+        {
+            std::lock_guard <std::mutex> locker (m_mutex);
+            batch.swap(m_pending);
+        }
+        for (auto& subscriber : subscribers)
+        {
+            subscriber.second += batch;
+        }
+
+        // Send what subscribers take, and disconnect subscribers
+        // which hung up, or fell behind by more than the buffer.
+        for (auto ii = subscribers.begin(); ii != subscribers.end(); )
+        {
+            int fd = ii->first;
+            auto& buffer = ii->second;
+            bool alive = true;
+            char discard[256];
+            ssize_t length;
+            while ((length = recv(fd, discard, sizeof(discard), MSG_DONTWAIT)) > 0)
+            {
+                continue;
+            }
+            if (length == 0 || (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                alive = false;
+            }
+            while (alive && !buffer.empty())
+            {
+                ssize_t sent = send(fd, buffer.data(), buffer.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (sent < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (sent < 0)
+                {
+                    alive = errno == EAGAIN || errno == EWOULDBLOCK;
+                    break;
+                }
+                buffer.erase(0, sent);
+            }
+            if (alive && buffer.size() > MAX_BUFFER)
+            {
+                ++dropped;
+                alive = false;
+            }
+            if (!alive)
+            {
+                close(fd);
+                ii = subscribers.erase(ii);
+                m_subscribers = subscribers.size();
+                continue;
+            }
+            ++ii;
+        }
+    }
+
+    // Send the last events (as far as subscribers take them.)
+    std::lock_guard <std::mutex> locker (m_mutex);
+    for (auto& subscriber : subscribers)
+    {
+        subscriber.second += m_pending;
+        send(subscriber.first, subscriber.second.data(), subscriber.second.size(),
+             MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(subscriber.first);
+    }
+    m_pending.clear();
+    m_subscribers = 0;
+    if (dropped > 0)
+    {
+        std::cout << "Event stream dropped " << dropped
+                  << " slow subscribers" << std::endl;
+    }
+}
+
+}  // namespace sherlock.
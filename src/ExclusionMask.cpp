@@ -0,0 +1,114 @@
+/**
+   Exclusion masks of sources' views.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Parse a point "X,Y" (in ratios of frame width and height.)
+bool parsePoint(const std::string& text, cv::Point2f& point)
+{
+    std::istringstream tokens (text);
+    char comma;
+    if (!(tokens >> point.x >> comma >> point.y) || comma != ',' || !tokens.eof())
+    {
+        return false;
+    }
+    return point.x >= 0 && point.x <= 1 && point.y >= 0 && point.y <= 1;
+}
+
+}  // namespace.
+
+
+bool ExclusionMask::excludes(const cv::Point2f& point) const
+{
+    for (auto& polygon : polygons)
+    {
+        if (cv::pointPolygonTest(polygon, point, false) >= 0)
+        {
+            return true;
+        }
+    }
+    if (bitmap.empty())
+    {
+        return false;
+    }
+    int x = std::min(bitmap.cols - 1, std::max(0, (int)(point.x * bitmap.cols)));
+    int y = std::min(bitmap.rows - 1, std::max(0, (int)(point.y * bitmap.rows)));
+    return bitmap.at<uchar>(y, x) != 0;
+}
+
+
+void ExclusionMask::render(const cv::Size& size, cv::Mat& mask) const
+{
+    mask.create(size, CV_8U);
+    mask.setTo(cv::Scalar(0));
+    if (!bitmap.empty())
+    {
+        cv::Mat scaled;
+        cv::resize(bitmap, scaled, size, 0, 0, CV_INTER_NN);
+        mask.setTo(cv::Scalar(255), scaled);
+    }
+    std::vector <std::vector <cv::Point>> points;
+    for (auto& polygon : polygons)
+    {
+        points.push_back(std::vector <cv::Point> ());
+        for (auto& point : polygon)
+        {
+            points.back().push_back(cv::Point(
+                cvRound(point.x * size.width), cvRound(point.y * size.height)));
+        }
+    }
+    if (!points.empty())
+    {
+        cv::fillPoly(mask, points, cv::Scalar(255));
+    }
+}
+
+
+bool parseExclusionMask(const std::string& spec, ExclusionMask& mask)
+{
+    std::istringstream stream (spec);
+    std::vector <std::string> tokens (
+        (std::istream_iterator <std::string> (stream)),
+        std::istream_iterator <std::string> ());
+    ExclusionMask parsed;
+    for (size_t ii = 0; ii < tokens.size(); )
+    {
+        auto& key = tokens[ii++];
+        if (key == "polygon")
+        {
+            std::vector <cv::Point2f> polygon;
+            cv::Point2f point;
+            for (; ii < tokens.size() && parsePoint(tokens[ii], point); ++ii)
+            {
+                polygon.push_back(point);
+            }
+            if (polygon.size() < 3)
+            {
+                return false;
+            }
+            parsed.polygons.push_back(polygon);
+            continue;
+        }
+        if (key == "bitmap" && ii < tokens.size() && parsed.bitmap.empty())
+        {
+            parsed.bitmap = cv::imread(tokens[ii++], 0);
+            if (!parsed.bitmap.empty()) continue;
+        }
+        return false;
+    }
+    mask = parsed;
+    return true;
+}
+
+}  // namespace sherlock.
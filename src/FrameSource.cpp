@@ -0,0 +1,303 @@
+/**
+   Frame sources of the capture multiplexer.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+// Include system headers.
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Number of buffers streaming V4L2 frames.
+const int V4L2_BUFFERS = 4;
+
+// Issue an ioctl, retrying when interrupted.
+int xioctl(const int& fd, const unsigned long& request, void* arg)
+{
+    int result;
+    do
+    {
+        result = ioctl(fd, request, arg);
+    }
+    while (result < 0 && errno == EINTR);
+    return result;
+}
+
+}  // namespace.
+
+
+FrameSource::FrameSource(const std::string& name, const float& max_fps, const bool& live) :
+    m_ended  (false),
+    m_name   (name),
+    m_live   (live),
+    m_pacer  (max_fps),
+    m_count  (0),
+    m_ticker ({ 1, 5, 10 })
+{/* Empty. */}
+
+
+void FrameSource::push(cv::Mat* frame)
+{
+    if (frame)
+    {
+        ++m_count;
+        m_framerate.set(m_ticker.tick());
+        if (m_outputs.empty())
+        {
+            delete frame;
+            return;
+        }
+    }
+    for (auto output : m_outputs)
+    {
+        output->push(frame);
+    }
+}
+
+
+RawSource::RawSource(
+    const std::string& fname,
+    const int& width,
+    const int& height,
+    const float& max_fps
+    ) :
+    FrameSource   (fname, max_fps, false),
+    m_fname  (fname),
+    m_width  (width),
+    m_height (height),
+    m_fd     (-1),
+    m_frame  (NULL),
+    m_filled (0)
+{/* Empty. */}
+
+
+RawSource::~RawSource()
+{
+    delete m_frame;
+    if (m_fd > STDIN_FILENO)
+    {
+        close(m_fd);
+    }
+}
+
+
+bool RawSource::open()
+{
+    if (m_fname == "-")
+    {
+        m_fd = STDIN_FILENO;
+        int flags = fcntl(m_fd, F_GETFL);
+        return flags >= 0 && fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+    m_fd = ::open(m_fname.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    return m_fd >= 0;
+}
+
+
+cv::Mat* RawSource::read(const bool& discard)
+{
+    if (!m_frame)
+    {
+        m_frame = new cv::Mat;
+        MatPool::attach(*m_frame);
+        m_frame->create(m_height, m_width, CV_8UC3);
+        m_filled = 0;
+    }
+
+    // Read until the frame is complete, or nothing is left to read.
+    size_t total = m_frame->total() * m_frame->elemSize();
+    while (m_filled < total)
+    {
+        ssize_t count = ::read(m_fd, m_frame->data + m_filled, total - m_filled);
+        if (count > 0)
+        {
+            m_filled += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return NULL;
+        }
+
+        // End of the stream (a partial frame is dropped.)
+        if (count < 0)
+        {
+            std::cout << "Warning: Failed to read " << m_fname
+                      << ": " << strerror(errno) << std::endl;
+        }
+        m_ended = true;
+        delete m_frame;
+        m_frame = NULL;
+        return NULL;
+    }
+    auto frame = m_frame;
+    m_frame = NULL;
+    if (discard)
+    {
+        delete frame;
+        return NULL;
+    }
+    return frame;
+}
+
+
+V4L2Source::V4L2Source(
+    const std::string& device,
+    const int& width,
+    const int& height,
+    const float& max_fps
+    ) :
+    FrameSource      (device, max_fps, true),
+    m_device    (device),
+    m_width     (width),
+    m_height    (height),
+    m_stride    (0),
+    m_fd        (-1),
+    m_streaming (false)
+{/* Empty. */}
+
+
+V4L2Source::~V4L2Source()
+{
+    if (m_streaming)
+    {
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+    }
+    for (auto& buffer : m_buffers)
+    {
+        munmap(buffer.start, buffer.length);
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+
+bool V4L2Source::open()
+{
+    m_fd = ::open(m_device.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    // Request YUYV frames of the given size (the driver may
+    // adjust the size to the nearest it supports.)
+    struct v4l2_format format;
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = m_width;
+    format.fmt.pix.height = m_height;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+    format.fmt.pix.field = V4L2_FIELD_ANY;
+    if (xioctl(m_fd, VIDIOC_S_FMT, &format) < 0
+        || format.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV)
+    {
+        std::cout << "Warning: " << m_device << " does not capture YUYV" << std::endl;
+        return false;
+    }
+    m_width = format.fmt.pix.width;
+    m_height = format.fmt.pix.height;
+
+    // Rows may be padded (e.g. for alignment.)
+    m_stride = std::max <size_t> (format.fmt.pix.bytesperline, m_width * 2);
+
+    // Map the buffers, and queue them all for capture.
+    struct v4l2_requestbuffers request;
+    memset(&request, 0, sizeof(request));
+    request.count = V4L2_BUFFERS;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(m_fd, VIDIOC_REQBUFS, &request) < 0 || request.count < 2)
+    {
+        std::cout << "Warning: " << m_device << " does not stream" << std::endl;
+        return false;
+    }
+    for (unsigned index = 0; index < request.count; ++index)
+    {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        if (xioctl(m_fd, VIDIOC_QUERYBUF, &buf) < 0)
+        {
+            return false;
+        }
+        void* start = mmap(
+            NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, buf.m.offset);
+        if (start == MAP_FAILED)
+        {
+            return false;
+        }
+        m_buffers.push_back({ start, buf.length });
+        if (xioctl(m_fd, VIDIOC_QBUF, &buf) < 0)
+        {
+            return false;
+        }
+    }
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(m_fd, VIDIOC_STREAMON, &type) < 0)
+    {
+        return false;
+    }
+    m_streaming = true;
+    return true;
+}
+
+
+cv::Mat* V4L2Source::read(const bool& discard)
+{
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(m_fd, VIDIOC_DQBUF, &buf) < 0)
+    {
+        if (errno != EAGAIN)
+        {
+            std::cout << "Warning: Failed to capture from " << m_device
+                      << ": " << strerror(errno) << std::endl;
+            m_ended = true;
+        }
+        return NULL;
+    }
+
+    // Convert the frame (unless discarded), and requeue the buffer.
+    cv::Mat* frame = NULL;
+    if (!discard && !(buf.flags & V4L2_BUF_FLAG_ERROR))
+    {
+        cv::Mat yuyv (m_height, m_width, CV_8UC2, m_buffers[buf.index].start, m_stride);
+        frame = new cv::Mat;
+        MatPool::attach(*frame);
+        cv::cvtColor(yuyv, *frame, CV_YUV2BGR_YUYV);
+    }
+    if (xioctl(m_fd, VIDIOC_QBUF, &buf) < 0)
+    {
+        std::cout << "Warning: Failed to requeue buffer of " << m_device << std::endl;
+        m_ended = true;
+    }
+    return frame;
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,180 @@
+/**
+   The Fuser class implements cross-classifier fusion of detections.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <map>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+void Fuser::computeOverlaps(const int& index)
+{
+    // Plain loops over the arrays, which the compiler vectorizes.
+    const int count = m_x1.size();
+    const float x1 = m_x1[index], y1 = m_y1[index];
+    const float x2 = m_x2[index], y2 = m_y2[index];
+    const float area = m_area[index];
+    const float* px1 = m_x1.data();
+    const float* py1 = m_y1.data();
+    const float* px2 = m_x2.data();
+    const float* py2 = m_y2.data();
+    const float* parea = m_area.data();
+    float* overlap = m_overlap.data();
+    for (int ii = 0; ii < count; ++ii)
+    {
+        float w = std::max(0.f, std::min(x2, px2[ii]) - std::max(x1, px1[ii]));
+        float h = std::max(0.f, std::min(y2, py2[ii]) - std::max(y1, py1[ii]));
+        float inter = w * h;
+        overlap[ii] = inter / (area + parea[ii] - inter);
+    }
+}
+
+
+void Fuser::fuse(
+    const std::vector <Detections*>& batches,
+    const Parameters& params,
+    Detections& fused)
+{
+    // Gather the candidates of all classifiers.
+    m_x1.clear(); m_y1.clear(); m_x2.clear(); m_y2.clear(); m_area.clear();
+    m_label.clear();
+    for (auto batch : batches)
+    {
+        for (size_t ii = 0; ii < batch->size(); ++ii)
+        {
+            m_x1.push_back(batch->x[ii]);
+            m_y1.push_back(batch->y[ii]);
+            m_x2.push_back(batch->x[ii] + batch->width[ii]);
+            m_y2.push_back(batch->y[ii] + batch->height[ii]);
+            m_area.push_back((float)batch->width[ii] * batch->height[ii]);
+            m_label.push_back(batch->classifierOf(ii));
+        }
+    }
+    const int count = m_x1.size();
+    m_overlap.resize(count);
+
+    // Support of each candidate is its total overlap with
+    // the others; best-supported candidates are kept first.
+    m_support.assign(count, 0.f);
+    for (int ii = 0; ii < count; ++ii)
+    {
+        computeOverlaps(ii);
+        for (int jj = 0; jj < count; ++jj)
+        {
+            m_support[ii] += m_overlap[jj] >= params.iou ? m_overlap[jj] : 0.f;
+        }
+    }
+    m_order.resize(count);
+    for (int ii = 0; ii < count; ++ii)
+    {
+        m_order[ii] = ii;
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+        return m_support[a] > m_support[b]; });
+
+    // Merge each kept candidate with the ones it suppresses.
+    m_suppressed.assign(count, false);
+    std::map <int, float> votes;
+    for (auto best : m_order)
+    {
+        if (m_suppressed[best])
+        {
+            continue;
+        }
+        computeOverlaps(best);
+        votes.clear();
+        float weight = 0, x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        for (int ii = 0; ii < count; ++ii)
+        {
+            if (m_suppressed[ii] || m_overlap[ii] < params.iou)
+            {
+                continue;
+            }
+            // Rectangles are averaged weighted by their overlap
+            // with the kept one (which weighs 1.)
+            m_suppressed[ii] = true;
+            float w = m_overlap[ii];
+            x1 += w * m_x1[ii];
+            y1 += w * m_y1[ii];
+            x2 += w * m_x2[ii];
+            y2 += w * m_y2[ii];
+            weight += w;
+            votes[m_label[ii]] += w;
+        }
+        if ((int)votes.size() < params.votes)
+        {
+            continue;
+        }
+
+        // The fused detection belongs to its strongest voter.
+        auto label = std::max_element(
+            votes.begin(), votes.end(),
+            [](const std::pair <const int, float>& a,
+               const std::pair <const int, float>& b) {
+                return a.second < b.second; })->first;
+        cv::Rect rect (
+            cvRound(x1 / weight),
+            cvRound(y1 / weight),
+            cvRound((x2 - x1) / weight),
+            cvRound((y2 - y1) / weight));
+        fused.push_back(rect, label, (float)votes.size() / std::max<size_t>(1, batches.size()));
+    }
+}
+
+
+void Fuser::run()
+{
+    applyPlacement("fusion", m_placement);
+    Trace::setThreadName("fusion");
+    PerfCounters::attach("fusion");
+
+    // Batches of frames in flight, by frame.
+    std::map <const cv::Mat*, std::vector <Detections*>> pending;
+
+    // Pull from the queue while there are valid batches.
+    Detections* batch;
+    m_input_queue.wait_and_pop(batch);
+    while(batch)
+    {
+        if(batch->classifier != Detections::END_OF_FRAME)
+        {
+            pending[batch->frame].push_back(batch);
+        }
+        else
+        {
+            // Fuse the batches of the released frame (if any.)
+            auto frame = pending.find(batch->frame);
+            if(frame != pending.end())
+            {
+                auto fused = m_pool.acquire();
+                fused->frame = batch->frame;
+                fused->classifier = Detections::FUSED;
+                fuse(frame->second, m_params.get(), *fused);
+                m_output_queue.push(fused);
+                for(auto detections : frame->second)
+                {
+                    m_pool.release(detections);
+                }
+                pending.erase(frame);
+                PerfCounters::frameDone();
+            }
+            m_pool.release(batch);
+        }
+        m_input_queue.wait_and_pop(batch);
+    }
+
+    // Return batches of frames never released to the pool.
+    for(auto& frame : pending)
+    {
+        for(auto detections : frame.second)
+        {
+            m_pool.release(detections);
+        }
+    }
+}
+
+}  // namespace sherlock.
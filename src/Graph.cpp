@@ -0,0 +1,245 @@
+/**
+   Processing graph descriptions.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Names of stage kinds (in order of GraphStage::Kind.)
+const std::vector <std::string> KINDS = {
+    "capture",
+    "display",
+    "classifiers",
+    "batch",
+    "fusion",
+};
+
+// Keywords of stage specifications.
+const std::vector <std::string> KEYWORDS = {
+    "input",
+    "threads",
+    "policy",
+    "placement",
+};
+
+// Return the kind of stage the given kind takes its input from
+// (the first of two, for fusion), or -1 if none.
+int inputKind(const GraphStage::Kind& kind, const bool& second = false)
+{
+    switch (kind)
+    {
+    case GraphStage::DISPLAY:
+    case GraphStage::CLASSIFIERS:
+    case GraphStage::BATCH:
+        return second ? -1 : GraphStage::CAPTURE;
+    case GraphStage::FUSION:
+        return second ? GraphStage::BATCH : GraphStage::CLASSIFIERS;
+    default:
+        return -1;
+    }
+}
+
+}  // namespace.
+
+
+const GraphStage* Graph::find(const GraphStage::Kind& kind) const
+{
+    for (auto& stage : stages)
+    {
+        if (stage.kind == kind)
+        {
+            return &stage;
+        }
+    }
+    return NULL;
+}
+
+
+const GraphStage* Graph::get(const std::string& name) const
+{
+    for (auto& stage : stages)
+    {
+        if (stage.name == name)
+        {
+            return &stage;
+        }
+    }
+    return NULL;
+}
+
+
+bool parseGraphStage(const std::string& spec, GraphStage& stage)
+{
+    std::istringstream tokens (spec);
+    std::string kind;
+    if (!(tokens >> kind))
+    {
+        return false;
+    }
+    auto found = std::find(KINDS.begin(), KINDS.end(), kind);
+    if (found == KINDS.end())
+    {
+        return false;
+    }
+    GraphStage parsed;
+    parsed.name = stage.name;
+    parsed.kind = (GraphStage::Kind)(found - KINDS.begin());
+
+    // Collect the values of every keyword (up to the next keyword.)
+    std::map <std::string, std::string> values;
+    std::string key, token;
+    while (tokens >> token)
+    {
+        if (std::find(KEYWORDS.begin(), KEYWORDS.end(), token) != KEYWORDS.end())
+        {
+            if (values.count(token))
+            {
+                return false;
+            }
+            key = token;
+            values[key] = "";
+            continue;
+        }
+        if (key.empty())
+        {
+            return false;
+        }
+        values[key] += (values[key].empty() ? "" : " ") + token;
+    }
+
+    if (values.count("input"))
+    {
+        parsed.input = values["input"];
+        if (parsed.input.empty() || parsed.input.find(' ') != std::string::npos)
+        {
+            return false;
+        }
+    }
+    if (values.count("threads"))
+    {
+        std::istringstream threads (values["threads"]);
+        if (!(threads >> parsed.threads) || !threads.eof() || parsed.threads < 1)
+        {
+            return false;
+        }
+    }
+    if (values.count("policy"))
+    {
+        if (!parseEdgePolicy(values["policy"], parsed.policy))
+        {
+            return false;
+        }
+        parsed.has_policy = true;
+    }
+    if (values.count("placement"))
+    {
+        if (!parsePlacement(values["placement"], parsed.placement))
+        {
+            return false;
+        }
+        parsed.has_placement = true;
+    }
+    stage = parsed;
+    return true;
+}
+
+
+bool checkGraph(Graph& graph, std::string& error)
+{
+    // Count stages of every kind.
+    std::vector <int> counts (KINDS.size(), 0);
+    for (auto& stage : graph.stages)
+    {
+        ++counts[stage.kind];
+    }
+    for (size_t kind = 0; kind < KINDS.size(); ++kind)
+    {
+        if (counts[kind] > 1)
+        {
+            error = "more than one " + KINDS[kind] + " stage";
+            return false;
+        }
+    }
+    if (counts[GraphStage::CAPTURE] == 0)
+    {
+        error = "no capture stage";
+        return false;
+    }
+    if (counts[GraphStage::CLASSIFIERS] + counts[GraphStage::BATCH] != 1)
+    {
+        error = "not exactly one classifiers or batch stage";
+        return false;
+    }
+
+    for (auto& stage : graph.stages)
+    {
+        auto first = inputKind(stage.kind);
+        auto second = inputKind(stage.kind, true);
+        if (first < 0)
+        {
+            if (!stage.input.empty())
+            {
+                error = stage.name + " takes no input";
+                return false;
+            }
+        }
+        else if (stage.input.empty())
+        {
+            // Feed the stage from its only candidate.
+            auto input = graph.find((GraphStage::Kind)first);
+            if (!input && second >= 0)
+            {
+                input = graph.find((GraphStage::Kind)second);
+            }
+            stage.input = input->name;
+        }
+        else
+        {
+            auto input = graph.get(stage.input);
+            if (!input || (input->kind != first && input->kind != second))
+            {
+                error = stage.name + " cannot take input from " + stage.input;
+                return false;
+            }
+        }
+        if (stage.threads > 1
+            && stage.kind != GraphStage::CLASSIFIERS
+            && stage.kind != GraphStage::BATCH)
+        {
+            error = stage.name + " runs on a single thread";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+std::string describeGraph(const Graph& graph)
+{
+    std::ostringstream out;
+    for (auto& stage : graph.stages)
+    {
+        out << stage.name << " (" << KINDS[stage.kind] << ")";
+        if (!stage.input.empty())
+        {
+            out << " <- " << stage.input;
+        }
+        if (stage.threads > 1)
+        {
+            out << ", " << stage.threads << " threads";
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,280 @@
+/**
+   The MatPool class implements pooled allocation of matrix data.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+struct MatPool::Block
+{
+    Block* next;
+    Arena* arena;
+    int size_class;    // Negative if not pooled.
+};
+
+namespace {
+
+// Buffers are preceded by their block header,
+// padded to keep their data aligned to cache lines.
+const size_t HEADER = 64;
+static_assert(sizeof(MatPool::Block) <= HEADER, "Block header too large");
+
+// Return the size class of given buffer size (negative if too large.)
+// Classes are 256 bytes, then four per power of two
+// (320, 384, 448, 512, 640, ...)
+int sizeClass(const size_t& size)
+{
+    if (size <= 256)
+    {
+        return 0;
+    }
+    int power = 63 - __builtin_clzll(size - 1);
+    int quarter = ((size - 1) >> (power - 2)) & 3;
+    int size_class = (power - 8)*4 + quarter + 1;
+    return size_class < MatPool::CLASSES ? size_class : -1;
+}
+
+// Return the buffer size of given size class.
+size_t classSize(const int& size_class)
+{
+    if (size_class == 0)
+    {
+        return 256;
+    }
+    int power = 8 + (size_class - 1)/4;
+    int quarter = (size_class - 1)%4;
+    return (size_t)(5 + quarter) << (power - 2);
+}
+
+// Pool state of a thread: its arena, released
+// (for another thread to take over) when the thread exits.
+struct ThreadState
+{
+    MatPool::Arena* arena = nullptr;
+    void* stage = nullptr;
+    ~ThreadState()
+    {
+        if (arena)
+        {
+            arena->in_use = false;
+        }
+    }
+};
+thread_local ThreadState t_state;
+
+}  // namespace.
+
+
+MatPool::Arena::Arena() :
+    has_remote (false),
+    in_use     (false)
+{
+    std::fill(local, local + CLASSES, nullptr);
+    std::fill(remote, remote + CLASSES, nullptr);
+}
+
+
+MatPool& MatPool::instance()
+{
+    // Never destroyed, as matrices may outlive any static object.
+    static MatPool* pool = new MatPool;
+    return *pool;
+}
+
+
+void MatPool::attach(cv::Mat& mat)
+{
+    mat.release();
+    mat.allocator = &instance();
+}
+
+
+void MatPool::setStage(const std::string& name)
+{
+    auto& pool = instance();
+    std::lock_guard <std::mutex> locker (pool.m_mutex);
+    t_state.stage = &pool.m_stages[name];
+}
+
+
+MatPool::Stage& MatPool::getStage()
+{
+    if (!t_state.stage)
+    {
+        setStage("other");
+    }
+    return *static_cast <Stage*> (t_state.stage);
+}
+
+
+MatPool::Arena& MatPool::getArena()
+{
+    if (!t_state.arena)
+    {
+        // Take over the arena of an exited thread, if any.
+        std::lock_guard <std::mutex> locker (m_mutex);
+        for (auto& arena : m_arenas)
+        {
+            if (!arena.in_use)
+            {
+                t_state.arena = &arena;
+                break;
+            }
+        }
+        if (!t_state.arena)
+        {
+            m_arenas.emplace_back();
+            t_state.arena = &m_arenas.back();
+        }
+        t_state.arena->in_use = true;
+    }
+    return *t_state.arena;
+}
+
+
+void MatPool::reclaim(Arena& arena)
+{
+    std::lock_guard <std::mutex> locker (arena.mutex);
+    for (int ii = 0; ii < CLASSES; ++ii)
+    {
+        if (!arena.remote[ii])
+        {
+            continue;
+        }
+        auto last = arena.remote[ii];
+        while (last->next)
+        {
+            last = last->next;
+        }
+        last->next = arena.local[ii];
+        arena.local[ii] = arena.remote[ii];
+        arena.remote[ii] = nullptr;
+    }
+    arena.has_remote = false;
+}
+
+
+void MatPool::allocate(
+    int dims,
+    const int* sizes,
+    int type,
+    int*& refcount,
+    uchar*& datastart,
+    uchar*& data,
+    size_t* step)
+{
+    // Lay out the data continuously, followed by the reference count
+    // (as cv::Mat does with its default allocation.)
+    size_t total = CV_ELEM_SIZE(type);
+    for (int ii = dims - 1; ii >= 0; --ii)
+    {
+        step[ii] = total;
+        total *= sizes[ii];
+    }
+    total = cv::alignSize(total, sizeof(*refcount));
+    size_t size = total + sizeof(*refcount);
+
+    // Recycle a block of the size class, if any.
+    auto& stage = getStage();
+    ++stage.allocations;
+    int size_class = sizeClass(size);
+    Block* block = nullptr;
+    if (size_class >= 0)
+    {
+        auto& arena = getArena();
+        if (!arena.local[size_class] && arena.has_remote)
+        {
+            reclaim(arena);
+        }
+        block = arena.local[size_class];
+        if (block)
+        {
+            arena.local[size_class] = block->next;
+            ++stage.reused;
+        }
+    }
+
+    // Allocate a new one otherwise.
+    if (!block)
+    {
+        size_t bytes = size_class >= 0 ? classSize(size_class) : size;
+        void* memory;
+        if (posix_memalign(&memory, HEADER, HEADER + bytes) != 0)
+        {
+            throw std::bad_alloc();
+        }
+        block = static_cast <Block*> (memory);
+        block->arena = size_class >= 0 ? &getArena() : nullptr;
+        block->size_class = size_class;
+        ++stage.heap;
+        stage.heap_bytes += bytes;
+    }
+
+    datastart = data = reinterpret_cast <uchar*> (block) + HEADER;
+    refcount = reinterpret_cast <int*> (data + total);
+    *refcount = 1;
+}
+
+
+void MatPool::deallocate(int* refcount, uchar* datastart, uchar* data)
+{
+    if (!datastart)
+    {
+        return;
+    }
+    auto block = reinterpret_cast <Block*> (datastart - HEADER);
+    int size_class = block->size_class;
+    if (size_class < 0)
+    {
+        free(block);
+        return;
+    }
+
+    // Return the block to the arena it came from: without locking
+    // if that of the calling thread, to be reclaimed otherwise.
+    auto& owner = *block->arena;
+    if (&owner == t_state.arena)
+    {
+        block->next = owner.local[size_class];
+        owner.local[size_class] = block;
+        return;
+    }
+    std::lock_guard <std::mutex> locker (owner.mutex);
+    block->next = owner.remote[size_class];
+    owner.remote[size_class] = block;
+    owner.has_remote = true;
+}
+
+
+std::map <std::string, MatPool::Counters> MatPool::getCounters()
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    std::map <std::string, Counters> counters;
+    for (auto& stage : m_stages)
+    {
+        auto& snapshot = counters[stage.first];
+        snapshot.allocations = stage.second.allocations;
+        snapshot.reused = stage.second.reused;
+        snapshot.heap = stage.second.heap;
+        snapshot.heap_bytes = stage.second.heap_bytes;
+    }
+    return counters;
+}
+
+
+std::ostream& operator<<(std::ostream& out, const MatPool::Counters& counters)
+{
+    return out << counters.allocations << " allocations, "
+               << counters.reused << " reused, "
+               << counters.heap << " from heap ("
+               << counters.heap_bytes / (1024*1024) << " MiB)";
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,252 @@
+/**
+   The Multiplexer class implements capture from many sources on one thread.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// Include system headers.
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+Multiplexer::Multiplexer(const int& duration) :
+    m_duration (duration),
+    m_stop_fd  (eventfd(0, EFD_CLOEXEC))
+{/* Empty. */}
+
+
+Multiplexer::~Multiplexer()
+{
+    if (m_stop_fd >= 0)
+    {
+        close(m_stop_fd);
+    }
+}
+
+
+void Multiplexer::stop()
+{
+    uint64_t one = 1;
+    if (m_stop_fd >= 0 && write(m_stop_fd, &one, sizeof(one)) < 0)
+    {
+        std::cout << "Warning: Failed to stop capture" << std::endl;
+    }
+}
+
+
+void Multiplexer::report(std::ostream& out)
+{
+    for (auto& source : m_sources)
+    {
+        out << "Source " << source->getName() << ": "
+            << source->getCount() << " frames" << std::endl;
+        source->getPacer().report(out);
+    }
+}
+
+
+void Multiplexer::run()
+{
+    applyPlacement("capture", m_placement);
+    Trace::setThreadName("capture");
+    PerfCounters::attach("capture");
+    MatPool::setStage("capture");
+
+    // The state of every source: whether epoll waits on it
+    // (rather than it being always ready), whether it is
+    // armed (waited on for reading), and whether it has ended.
+    struct State
+    {
+        bool polled = false;
+        bool armed = false;
+        bool ended = false;
+    };
+    std::vector <State> states (m_sources.size());
+    size_t remaining = m_sources.size();
+    auto end = [&](const size_t& index)
+    {
+        states[index].ended = true;
+        m_sources[index]->push(NULL);
+        --remaining;
+    };
+
+    // Wait on the stop event and the deadline timer (tagged past
+    // the sources), and the sources.  The timer runs on the monotonic
+    // clock of the pacers, waking up on the earliest deadline.
+    const auto STOP_TAG = m_sources.size();
+    const auto TIMER_TAG = m_sources.size() + 1;
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = STOP_TAG;
+    bool waiting = epoll_fd >= 0 && m_stop_fd >= 0 && timer_fd >= 0
+        && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_stop_fd, &event) == 0;
+    event.data.u64 = TIMER_TAG;
+    if (!waiting || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) < 0)
+    {
+        std::cout << "Warning: Cannot multiplex capture" << std::endl;
+        for (size_t ii = 0; ii < m_sources.size(); ++ii)
+        {
+            end(ii);
+        }
+        if (epoll_fd >= 0) close(epoll_fd);
+        if (timer_fd >= 0) close(timer_fd);
+        return;
+    }
+    for (size_t ii = 0; ii < m_sources.size(); ++ii)
+    {
+        auto& source = *m_sources[ii];
+        if (!source.open())
+        {
+            std::cout << "Warning: Failed to open source " << source.getName() << std::endl;
+            end(ii);
+            continue;
+        }
+        event.events = EPOLLIN;
+        event.data.u64 = ii;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, source.getFd(), &event) == 0)
+        {
+            states[ii].polled = states[ii].armed = true;
+        }
+        else if (errno != EPERM)
+        {
+            std::cout << "Warning: Cannot wait on source " << source.getName() << std::endl;
+            end(ii);
+        }
+    }
+
+    // Run for designated amount of time, until stopped,
+    // or until all sources have ended.
+    auto stop = Pacer::now() + std::chrono::seconds(m_duration);
+    std::vector <struct epoll_event> events (m_sources.size() + 2);
+    std::vector <size_t> ready;
+    bool stopping = false;
+    while (!stopping && remaining > 0)
+    {
+        // Arm the sources due for their next frame (live ones always),
+        // and find the earliest deadline of the others.
+        auto now = Pacer::now();
+        auto wake = m_duration > 0 ? stop : Pacer::Clock::time_point::max();
+        ready.clear();
+        for (size_t ii = 0; ii < m_sources.size(); ++ii)
+        {
+            auto& source = *m_sources[ii];
+            if (states[ii].ended)
+            {
+                continue;
+            }
+            auto deadline = source.getPacer().getDeadline();
+            bool due = deadline <= now;
+            if (!due)
+            {
+                wake = std::min(wake, deadline);
+            }
+            if (!states[ii].polled)
+            {
+                if (due) ready.push_back(ii);
+                continue;
+            }
+            // Disarmed sources are removed from epoll altogether,
+            // since hangups are reported regardless of the events.
+            bool armed = due || source.isLive();
+            if (armed != states[ii].armed)
+            {
+                event.events = EPOLLIN;
+                event.data.u64 = ii;
+                epoll_ctl(epoll_fd, armed ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, source.getFd(), &event);
+                states[ii].armed = armed;
+            }
+        }
+
+        // Wait for sources ready (not at all, if some are already),
+        // up to the earliest deadline.
+        struct itimerspec timer;
+        memset(&timer, 0, sizeof(timer));
+        if (ready.empty() && wake != Pacer::Clock::time_point::max())
+        {
+            auto since_epoch = wake.time_since_epoch();
+            auto sec = std::chrono::duration_cast <std::chrono::seconds> (since_epoch);
+            timer.it_value.tv_sec = sec.count();
+            timer.it_value.tv_nsec = std::chrono::duration_cast <std::chrono::nanoseconds> (
+                since_epoch - sec).count();
+        }
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timer, NULL);
+        int count = epoll_wait(epoll_fd, events.data(), events.size(), ready.empty() ? -1 : 0);
+        if (count < 0 && errno != EINTR)
+        {
+            std::cout << "Warning: Failed to wait for sources" << std::endl;
+            break;
+        }
+        if (m_duration > 0 && Pacer::now() >= stop)
+        {
+            break;
+        }
+        for (int ii = 0; ii < count; ++ii)
+        {
+            if (events[ii].data.u64 == STOP_TAG)
+            {
+                stopping = true;
+                continue;
+            }
+            if (events[ii].data.u64 == TIMER_TAG)
+            {
+                // Expirations are cleared as the timer is set again.
+                continue;
+            }
+            ready.push_back(events[ii].data.u64);
+        }
+
+        // Read the sources ready, keeping frames due
+        // (live sources may have frames ahead of the deadline.)
+        for (auto index : ready)
+        {
+            auto& source = *m_sources[index];
+            bool due = source.getPacer().getDeadline() <= Pacer::now();
+            if (!due && !source.isLive())
+            {
+                continue;
+            }
+            auto frame = source.read(!due);
+            if (frame)
+            {
+                source.getPacer().advance();
+                source.push(frame);
+                PerfCounters::frameDone();
+            }
+            if (source.isEnded())
+            {
+                if (states[index].armed)
+                {
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, source.getFd(), &event);
+                }
+                end(index);
+            }
+        }
+    }
+    close(epoll_fd);
+    close(timer_fd);
+
+    // Signal end-of-processing by pushing NULL onto the outputs
+    // of the sources still running.
+    for (size_t ii = 0; ii < m_sources.size(); ++ii)
+    {
+        if (!states[ii].ended)
+        {
+            end(ii);
+        }
+    }
+}
+
+}  // namespace sherlock.
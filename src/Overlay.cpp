@@ -0,0 +1,76 @@
+/**
+   The Overlay class implements compositing of detections over frames.
+*/
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+void Overlay::update(const Detections& detections)
+{
+    if (detections.classifier == Detections::FUSED)
+    {
+        m_layers.clear();
+    }
+    auto& layer = m_layers[detections.classifier];
+    layer.rects.clear();
+    layer.classifiers.clear();
+    for (size_t ii = 0; ii < detections.size(); ++ii)
+    {
+        layer.rects.push_back(detections.rect(ii));
+        layer.classifiers.push_back(detections.classifierOf(ii));
+    }
+    layer.age = 0;
+}
+
+
+void Overlay::render(
+    const cv::Mat& frame,
+    const cv::Size& size,
+    Palette& palette,
+    const std::list <std::string>& lines,
+    cv::Mat& output)
+{
+    // Composite at display resolution (scaling the frame
+    // straight into the output, with no full-size copy.)
+    if (size == frame.size())
+    {
+        frame.copyTo(output);
+    }
+    else
+    {
+        cv::resize(frame, output, size, 0, 0, CV_INTER_AREA);
+    }
+    double fx = (double)size.width / frame.cols;
+    double fy = (double)size.height / frame.rows;
+
+    // Draw the detections held, dropping those held too long.
+    for (auto ii = m_layers.begin(); ii != m_layers.end(); )
+    {
+        auto& layer = ii->second;
+        if (layer.age++ >= m_hold)
+        {
+            ii = m_layers.erase(ii);
+            continue;
+        }
+        for (size_t jj = 0; jj < layer.rects.size(); ++jj)
+        {
+            auto& rect = layer.rects[jj];
+            cv::rectangle(
+                output,
+                cv::Point(cvRound(rect.x * fx), cvRound(rect.y * fy)),
+                cv::Point(cvRound((rect.x + rect.width) * fx),
+                          cvRound((rect.y + rect.height) * fy)),
+                palette.get(layer.classifiers[jj]),
+                2  // thickness.
+                );
+        }
+        ++ii;
+    }
+
+    // Write the on-screen-display information.
+    writeOSD(output, lines, 0.04);
+}
+
+}  // namespace sherlock.
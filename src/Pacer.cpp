@@ -0,0 +1,177 @@
+/**
+   The Pacer class implements frame pacing.
+*/
+
+// Include standard headers.
+#include <cerrno>
+#include <cmath>
+#include <iomanip>
+#include <time.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Longest sleep between checks of the stop flag.
+const std::chrono::milliseconds STOP_POLL (50);
+
+}  // namespace.
+
+
+Pacer::Pacer(const float& max_fps) :
+    m_paced    (false),
+    m_interval (0),
+    m_started  (false),
+    m_count    (0),
+    m_missed   (0),
+    m_mean     (0),
+    m_m2       (0),
+    m_max      (0)
+{
+    setMaxFps(max_fps);
+}
+
+
+void Pacer::setMaxFps(const float& max_fps)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    m_paced = max_fps > 0 && std::isfinite(max_fps)
+        && max_fps < std::numeric_limits<float>::max();
+    if (m_paced)
+    {
+        m_interval = std::chrono::duration_cast <Clock::duration> (
+            std::chrono::duration <double> (1. / max_fps));
+    }
+}
+
+
+bool Pacer::wait(const std::atomic <bool>* stopping)
+{
+    if (!sleepUntil(getDeadline(), stopping))
+    {
+        return false;
+    }
+    advance();
+    return true;
+}
+
+
+Pacer::Clock::time_point Pacer::getDeadline()
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    if (!m_paced || !m_started)
+    {
+        return Clock::time_point::min();
+    }
+
+    // The next deadline follows the previous one (not the wakeup.)
+    return m_deadline + m_interval;
+}
+
+
+void Pacer::advance()
+{
+    auto woken = now();
+    std::lock_guard <std::mutex> locker (m_mutex);
+    if (!m_paced)
+    {
+        m_started = false;
+        return;
+    }
+    if (!m_started)
+    {
+        m_started = true;
+        m_deadline = woken;
+        return;
+    }
+    m_deadline += m_interval;
+    double jitter = std::chrono::duration <double, std::micro> (woken - m_deadline).count();
+    if (woken - m_deadline > m_interval)
+    {
+        // Too far behind: restart the schedule.
+        m_deadline = woken;
+        ++m_missed;
+    }
+    ++m_count;
+    double delta = jitter - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (jitter - m_mean);
+    m_max = std::max(m_max, jitter);
+}
+
+
+Pacer::Stats Pacer::getStats()
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    return {
+        m_count,
+        m_missed,
+        m_mean,
+        m_count > 1 ? std::sqrt(m_m2 / (m_count - 1)) : 0.,
+        m_max,
+    };
+}
+
+
+void Pacer::report(std::ostream& out)
+{
+    if (getStats().count == 0)
+    {
+        return;
+    }
+    auto stats = getStats();
+    out << std::fixed << std::setprecision(1)
+        << "Pacing jitter (usec): mean " << stats.mean
+        << ", stddev " << stats.stddev
+        << ", max " << stats.max
+        << " over " << stats.count << " frames ("
+        << stats.missed << " missed)" << std::endl;
+}
+
+
+bool Pacer::sleepUntil(
+    const Clock::time_point& deadline,
+    const std::atomic <bool>* stopping)
+{
+    while (true)
+    {
+        if (stopping && *stopping)
+        {
+            return false;
+        }
+
+        // Sleep up to the deadline, in slices if watching the stop flag
+        // (the last slice ending on the deadline itself, exactly.)
+        auto present = now();
+        if (deadline <= present)
+        {
+            return true;
+        }
+        auto wake = deadline;
+        if (stopping && deadline - present > STOP_POLL)
+        {
+            wake = present + STOP_POLL;
+        }
+
+        // The steady clock is the monotonic clock.
+        auto since_epoch = wake.time_since_epoch();
+        auto sec = std::chrono::duration_cast <std::chrono::seconds> (since_epoch);
+        auto nsec = std::chrono::duration_cast <std::chrono::nanoseconds> (since_epoch - sec);
+        struct timespec ts;
+        ts.tv_sec = sec.count();
+        ts.tv_nsec = nsec.count();
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+            continue;
+        }
+        if (wake == deadline)
+        {
+            return true;
+        }
+    }
+}
+
+}  // namespace sherlock.
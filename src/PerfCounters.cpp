@@ -0,0 +1,246 @@
+/**
+   Hardware performance counters of pipeline stages.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+// Include system headers.
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Names of counters (in order of PerfCounters::Counter.)
+const char* NAMES[PerfCounters::COUNTERS] = {
+    "cycles",
+    "instructions",
+    "llc_misses",
+    "context_switches",
+};
+
+// Event type and config of every counter.
+const uint32_t TYPES[PerfCounters::COUNTERS] = {
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_SOFTWARE,
+};
+const uint64_t CONFIGS[PerfCounters::COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_SW_CONTEXT_SWITCHES,
+};
+
+// Counts of a stage, added to by all its threads.
+struct Stage
+{
+    std::atomic <long> frames;
+    std::atomic <uint64_t> values[PerfCounters::COUNTERS];
+    bool available[PerfCounters::COUNTERS];
+};
+
+// Counts of every stage (kept for the whole run), whether counting
+// is enabled, whether unavailable counters have been reported, and
+// the mutex guarding them.
+struct Registry
+{
+    std::mutex mutex;
+    std::map <std::string, std::unique_ptr <Stage>> stages;
+    bool enabled = false;
+    bool warned = false;
+};
+
+Registry& registry()
+{
+    static auto instance = new Registry;
+    return *instance;
+}
+
+// Counters of a thread, and their values at the previous frame.
+struct ThreadCounters
+{
+    Stage* stage = NULL;
+    int fds[PerfCounters::COUNTERS];
+    uint64_t previous[PerfCounters::COUNTERS] = {};
+
+    ThreadCounters()
+    {
+        std::fill(fds, fds + PerfCounters::COUNTERS, -1);
+    }
+
+    ~ThreadCounters()
+    {
+        for (auto fd : fds)
+        {
+            if (fd >= 0) close(fd);
+        }
+    }
+};
+
+thread_local ThreadCounters counters;
+
+// Open a counter of the calling thread (on any CPU.)
+int openCounter(const uint32_t& type, const uint64_t& config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    // Context switches happen in the kernel, hence only hardware
+    // events are restricted to user space.
+    attr.exclude_kernel = type == PERF_TYPE_HARDWARE;
+    attr.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+// Read a counter.
+bool readCounter(const int& fd, uint64_t& value)
+{
+    return read(fd, &value, sizeof(value)) == sizeof(value);
+}
+
+}  // namespace.
+
+
+void PerfCounters::setEnabled(const bool& enabled)
+{
+    std::lock_guard <std::mutex> locker (registry().mutex);
+    registry().enabled = enabled;
+}
+
+
+void PerfCounters::attach(const std::string& name)
+{
+    auto& reg = registry();
+    {
+        std::lock_guard <std::mutex> locker (reg.mutex);
+        if (!reg.enabled)
+        {
+            return;
+        }
+    }
+
+    // Open what counters are available.
+    std::string unavailable;
+    for (int ii = 0; ii < COUNTERS; ++ii)
+    {
+        counters.fds[ii] = openCounter(TYPES[ii], CONFIGS[ii]);
+        if (counters.fds[ii] >= 0 && !readCounter(counters.fds[ii], counters.previous[ii]))
+        {
+            close(counters.fds[ii]);
+            counters.fds[ii] = -1;
+        }
+        if (counters.fds[ii] < 0)
+        {
+            unavailable += std::string(unavailable.empty() ? "" : ", ") + NAMES[ii]
+                + " (" + strerror(errno) + ")";
+        }
+    }
+
+    std::lock_guard <std::mutex> locker (reg.mutex);
+    if (!unavailable.empty() && !reg.warned)
+    {
+        std::cout << "Warning: Performance counters unavailable: " << unavailable
+                  << "; see /proc/sys/kernel/perf_event_paranoid" << std::endl;
+        reg.warned = true;
+    }
+    auto& stage = reg.stages[name];
+    if (!stage)
+    {
+        stage.reset(new Stage);
+        stage->frames = 0;
+        for (int ii = 0; ii < COUNTERS; ++ii)
+        {
+            stage->values[ii] = 0;
+            stage->available[ii] = true;
+        }
+    }
+    for (int ii = 0; ii < COUNTERS; ++ii)
+    {
+        stage->available[ii] = stage->available[ii] && counters.fds[ii] >= 0;
+    }
+    counters.stage = stage.get();
+}
+
+
+void PerfCounters::frameDone()
+{
+    if (!counters.stage)
+    {
+        return;
+    }
+    for (int ii = 0; ii < COUNTERS; ++ii)
+    {
+        uint64_t value;
+        if (counters.fds[ii] >= 0 && readCounter(counters.fds[ii], value))
+        {
+            counters.stage->values[ii] += value - counters.previous[ii];
+            counters.previous[ii] = value;
+        }
+    }
+    ++counters.stage->frames;
+}
+
+
+std::map <std::string, PerfCounters::Totals> PerfCounters::getTotals()
+{
+    auto& reg = registry();
+    std::lock_guard <std::mutex> locker (reg.mutex);
+    std::map <std::string, Totals> totals;
+    for (auto& stage : reg.stages)
+    {
+        auto& total = totals[stage.first];
+        total.frames = stage.second->frames;
+        for (int ii = 0; ii < COUNTERS; ++ii)
+        {
+            total.values[ii] = stage.second->values[ii];
+            total.available[ii] = stage.second->available[ii];
+        }
+    }
+    return totals;
+}
+
+
+std::ostream& operator<<(std::ostream& out, const PerfCounters::Totals& totals)
+{
+    out << "frames " << totals.frames;
+    auto frames = std::max(1L, totals.frames);
+    for (int ii = 0; ii < PerfCounters::COUNTERS; ++ii)
+    {
+        out << ", " << NAMES[ii] << "/frame ";
+        if (totals.available[ii])
+        {
+            out << std::fixed << std::setprecision(1) << (double)totals.values[ii] / frames;
+        }
+        else
+        {
+            out << "n/a";
+        }
+    }
+    if (totals.available[PerfCounters::CYCLES]
+        && totals.available[PerfCounters::INSTRUCTIONS]
+        && totals.values[PerfCounters::CYCLES] > 0)
+    {
+        out << ", ipc " << std::fixed << std::setprecision(2)
+            << (double)totals.values[PerfCounters::INSTRUCTIONS]
+            / totals.values[PerfCounters::CYCLES];
+    }
+    return out;
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,148 @@
+/**
+   The PipelineBase class implements running pipeline segments.
+*/
+
+// Include standard headers.
+#include <thread>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+PipelineBase::PipelineBase(
+    const std::vector <Segment*>& segments,
+    const EdgePolicy& policy) :
+    m_stopping (false)
+{
+    for (auto segment : segments)
+    {
+        m_segments.push_back(std::unique_ptr <Segment> (segment));
+    }
+    for (size_t ii = 1; ii < m_segments.size(); ++ii)
+    {
+        m_edges.push_back(std::unique_ptr <Edge <Frame*>> (new Edge <Frame*> (policy)));
+        m_edges.back()->setDropCallback([this](Frame* const& frame) { recycle(frame); });
+    }
+}
+
+
+EdgePolicy PipelineBase::blocking(const int& capacity)
+{
+    EdgePolicy policy;
+    policy.kind = EdgePolicy::BLOCK;
+    policy.capacity = capacity;
+    return policy;
+}
+
+
+void PipelineBase::run()
+{
+    std::vector <std::thread> threads;
+    for (size_t ii = 0; ii + 1 < m_segments.size(); ++ii)
+    {
+        threads.push_back(std::thread(&PipelineBase::runSegment, this, ii));
+    }
+    runSegment(m_segments.size() - 1);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+void PipelineBase::runSegment(const size_t& index)
+{
+    auto& segment = *m_segments[index];
+    auto input = index > 0 ? m_edges[index - 1].get() : nullptr;
+    auto output = index < m_edges.size() ? m_edges[index].get() : nullptr;
+    MatPool::setStage(index > 0 ? "segment " + std::to_string(index) : "source");
+
+    while (true)
+    {
+        // The source takes free frames, until stopped;
+        // others take frames from the segment before.
+        Frame* frame;
+        if (input)
+        {
+            input->wait_and_pop(frame);
+            if (!frame)
+            {
+                break;
+            }
+        }
+        else if (m_stopping)
+        {
+            break;
+        }
+        else
+        {
+            frame = acquire();
+        }
+
+        // The stream ends when the source says so; should a later
+        // segment end it, the source is stopped, and segments
+        // drain their input.
+        if ((input && m_stopping) || !segment.process(*frame))
+        {
+            recycle(frame);
+            if (!input)
+            {
+                break;
+            }
+            m_stopping = true;
+            continue;
+        }
+        if (output)
+        {
+            output->push(frame);
+        }
+        else
+        {
+            recycle(frame);
+        }
+    }
+
+    // Signal end-of-processing by pushing NULL onto the output.
+    if (output)
+    {
+        output->push(NULL);
+    }
+}
+
+
+Frame* PipelineBase::acquire()
+{
+    Frame* frame;
+    if (m_free.try_pop(frame))
+    {
+        return frame;
+    }
+    m_frames.push_back(std::unique_ptr <Frame> (new Frame));
+    MatPool::attach(m_frames.back()->image);
+    return m_frames.back().get();
+}
+
+
+void PipelineBase::recycle(Frame* frame)
+{
+    frame->osd.clear();
+    m_free.push(frame);
+}
+
+
+void PipelineBase::report(std::ostream& out)
+{
+    for (size_t ii = 0; ii < m_edges.size(); ++ii)
+    {
+        out << "Queue into segment " << ii + 1 << ": "
+            << m_edges[ii]->getCounters() << std::endl;
+    }
+    out << "Frames allocated: " << m_frames.size() << std::endl;
+    for (auto& stage : MatPool::instance().getCounters())
+    {
+        out << "Matrix pool of " << stage.first << ": " << stage.second << std::endl;
+    }
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,255 @@
+/**
+   Placement of pipeline threads on CPUs and NUMA nodes.
+*/
+
+// Include standard headers.
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Include system headers.
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Number of nodes covered by memory policy node masks.
+const unsigned long MAX_NODES = 8 * sizeof(unsigned long);
+
+// Parse a CPU list (e.g. "0-3,8"), appending to *cpus*.
+bool parseCpuList(const std::string& list, std::vector <int>& cpus)
+{
+    std::istringstream ranges (list);
+    std::string range;
+    while (std::getline(ranges, range, ','))
+    {
+        int first, last;
+        char dash;
+        std::istringstream tokens (range);
+        if (!(tokens >> first))
+        {
+            return false;
+        }
+        last = first;
+        if (tokens >> dash && (dash != '-' || !(tokens >> last)))
+        {
+            return false;
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return !cpus.empty();
+}
+
+// Format a CPU set as a CPU list.
+std::string formatCpuSet(const cpu_set_t& set)
+{
+    std::ostringstream out;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &set))
+        {
+            continue;
+        }
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &set))
+        {
+            ++last;
+        }
+        out << (out.tellp() > 0 ? "," : "") << cpu;
+        if (last > cpu)
+        {
+            out << "-" << last;
+        }
+        cpu = last;
+    }
+    return out.str();
+}
+
+// Return the CPUs of given NUMA node (empty if unknown.)
+std::vector <int> nodeCpus(const int& node)
+{
+    std::vector <int> cpus;
+    std::ifstream file (
+        "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(file, list) || !parseCpuList(list, cpus))
+    {
+        cpus.clear();
+    }
+    return cpus;
+}
+
+}  // namespace.
+
+
+bool parsePlacement(const std::string& spec, Placement& placement)
+{
+    std::istringstream tokens (spec);
+    Placement parsed;
+    std::string key;
+    while (tokens >> key)
+    {
+        std::string list;
+        if (key == "cpus" && tokens >> list && parseCpuList(list, parsed.cpus)) continue;
+        if (key == "node" && tokens >> parsed.node
+            && parsed.node >= 0 && parsed.node < (int)MAX_NODES) continue;
+        if (key == "fifo" || key == "rr")
+        {
+            parsed.policy = key == "fifo" ? Placement::FIFO : Placement::RR;
+            if (tokens >> parsed.priority
+                && parsed.priority >= sched_get_priority_min(SCHED_FIFO)
+                && parsed.priority <= sched_get_priority_max(SCHED_FIFO)) continue;
+        }
+        if (key == "nice" && tokens >> parsed.nice)
+        {
+            parsed.has_nice = true;
+            continue;
+        }
+        return false;
+    }
+    if (parsed.has_nice && parsed.policy != Placement::OTHER)
+    {
+        return false;
+    }
+    placement = parsed;
+    return true;
+}
+
+
+void applyPlacement(const std::string& name, const Placement& placement)
+{
+    if (placement.isDefault())
+    {
+        return;
+    }
+
+    // Allocate on the node (first touch by this thread places
+    // the pages, e.g. those of frames captured by it.)
+    if (placement.node >= 0)
+    {
+        unsigned long mask = 1ul << placement.node;
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, MAX_NODES + 1) < 0)
+        {
+            std::cout << "Warning: Failed to prefer node " << placement.node
+                      << " for " << name << " thread: " << strerror(errno) << std::endl;
+        }
+    }
+
+    // Run on the given CPUs (or the CPUs of the node.)
+    auto cpus = placement.cpus;
+    if (cpus.empty() && placement.node >= 0)
+    {
+        cpus = nodeCpus(placement.node);
+    }
+    if (!cpus.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : cpus)
+        {
+            CPU_SET(cpu, &set);
+        }
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error)
+        {
+            std::cout << "Warning: Failed to set CPUs of " << name
+                      << " thread: " << strerror(error) << std::endl;
+        }
+    }
+
+    // Schedule in real time (which requires privileges),
+    // or adjust the niceness of this thread alone.
+    if (placement.policy != Placement::OTHER)
+    {
+        sched_param param;
+        param.sched_priority = placement.priority;
+        int error = pthread_setschedparam(
+            pthread_self(),
+            placement.policy == Placement::FIFO ? SCHED_FIFO : SCHED_RR,
+            &param);
+        if (error)
+        {
+            std::cout << "Warning: Failed to set real-time scheduling of " << name
+                      << " thread: " << strerror(error) << std::endl;
+        }
+    }
+    else if (placement.has_nice
+             && setpriority(PRIO_PROCESS, syscall(SYS_gettid), placement.nice) < 0)
+    {
+        std::cout << "Warning: Failed to set niceness of " << name
+                  << " thread: " << strerror(errno) << std::endl;
+    }
+
+    std::cout << "Placed " << name << " thread: " << describePlacement() << std::endl;
+}
+
+
+std::string describePlacement()
+{
+    std::ostringstream out;
+    out << "cpu " << sched_getcpu();
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    {
+        out << " of " << formatCpuSet(set);
+    }
+
+    int policy;
+    sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0)
+    {
+        if (policy == SCHED_FIFO) out << ", fifo " << param.sched_priority;
+        else if (policy == SCHED_RR) out << ", rr " << param.sched_priority;
+        else out << ", nice " << getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+    }
+
+    int mode;
+    unsigned long mask = 0;
+    if (syscall(SYS_get_mempolicy, &mode, &mask, MAX_NODES + 1, NULL, 0) == 0
+        && mode != MPOL_DEFAULT)
+    {
+        out << ", memory on node";
+        for (unsigned long node = 0; node < MAX_NODES; ++node)
+        {
+            if (mask & (1ul << node))
+            {
+                out << " " << node;
+            }
+        }
+    }
+    return out.str();
+}
+
+
+int memoryNode(const void* address)
+{
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, address,
+                MPOL_F_NODE | MPOL_F_ADDR) < 0)
+    {
+        return -1;
+    }
+    return node;
+}
+
+}  // namespace sherlock.
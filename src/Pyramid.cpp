@@ -0,0 +1,155 @@
+// Include standard headers.
+#include <algorithm>
+#include <limits>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+Pyramid::Pyramid(
+    const cv::Mat& frame,
+    const double& scale_factor,
+    const double& resolution
+    ) :
+    m_scale_factor (scale_factor),
+    m_frame        (frame),
+    m_size         (reducedSize(frame.size(), resolution))
+{
+    // Enumerate the levels, with the same factor progression
+    // (and rounding) as cv::CascadeClassifier::detectMultiScale.
+    for (double factor = 1; ; factor *= scale_factor)
+    {
+        cv::Size size (
+            cvRound(m_size.width / factor),
+            cvRound(m_size.height / factor));
+        if (size.width < 1 || size.height < 1)
+        {
+            break;
+        }
+        m_levels.push_back(std::unique_ptr <Level> (new Level));
+        m_levels.back()->factor = factor;
+        m_levels.back()->size = size;
+        MatPool::attach(m_levels.back()->image);
+        MatPool::attach(m_levels.back()->sum);
+        MatPool::attach(m_levels.back()->sqsum);
+        MatPool::attach(m_levels.back()->tilted);
+        if (scale_factor <= 1)
+        {
+            break;
+        }
+    }
+}
+
+
+const cv::Mat& Pyramid::getGray()
+{
+    std::call_once(m_gray_once, [this]() {
+        m_gray = m_frame;
+        if (m_gray.size() != m_size)
+        {
+            cv::Mat temp;
+            MatPool::attach(temp);
+            cv::resize(m_gray, temp, m_size, 0, 0, CV_INTER_AREA);
+            m_gray = temp;
+        }
+        if (m_gray.channels() > 1)
+        {
+            cv::Mat temp;
+            MatPool::attach(temp);
+            cv::cvtColor(m_gray, temp, CV_BGR2GRAY);
+            m_gray = temp;
+        }
+        if (m_gray.depth() != CV_8U)
+        {
+            cv::Mat temp;
+            MatPool::attach(temp);
+            m_gray.convertTo(temp, CV_8U);
+            m_gray = temp;
+        }
+    });
+    return m_gray;
+}
+
+
+const cv::Mat& Pyramid::getImage(const int& level)
+{
+    auto& lev = *m_levels[level];
+    std::call_once(lev.image_once, [this, &lev]() {
+        auto& gray = getGray();
+        if (lev.size == gray.size())
+        {
+            lev.image = gray;
+        }
+        else
+        {
+            cv::resize(gray, lev.image, lev.size, 0, 0, CV_INTER_LINEAR);
+        }
+    });
+    return lev.image;
+}
+
+
+const cv::Mat& Pyramid::getSum(const int& level)
+{
+    auto& lev = *m_levels[level];
+    std::call_once(lev.sum_once, [this, &lev, &level]() {
+        cv::integral(getImage(level), lev.sum, lev.sqsum);
+    });
+    return lev.sum;
+}
+
+
+const cv::Mat& Pyramid::getSquaredSum(const int& level)
+{
+    getSum(level);
+    return m_levels[level]->sqsum;
+}
+
+
+const cv::Mat& Pyramid::getTilted(const int& level)
+{
+    auto& lev = *m_levels[level];
+    std::call_once(lev.tilted_once, [this, &lev, &level]() {
+        // Sums are recomputed into temporaries, as other
+        // threads may be reading the level's own.
+        cv::Mat sum, sqsum;
+        MatPool::attach(sum);
+        MatPool::attach(sqsum);
+        cv::integral(getImage(level), sum, sqsum, lev.tilted);
+    });
+    return lev.tilted;
+}
+
+
+std::shared_ptr <Pyramid> PyramidCache::get(
+    const cv::Mat* frame,
+    const double& scale_factor,
+    const double& resolution)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    auto& pyramid = m_pyramids[Key(frame, scale_factor, std::min(resolution, 1.))];
+    if (!pyramid)
+    {
+        pyramid.reset(new Pyramid(*frame, scale_factor, resolution));
+    }
+    return pyramid;
+}
+
+
+void PyramidCache::release(const cv::Mat* frame)
+{
+    std::lock_guard <std::mutex> locker (m_mutex);
+    auto first = m_pyramids.lower_bound(
+        Key(frame,
+            -std::numeric_limits <double>::infinity(),
+            -std::numeric_limits <double>::infinity()));
+    auto last = first;
+    while (last != m_pyramids.end() && std::get <0> (last->first) == frame)
+    {
+        ++last;
+    }
+    m_pyramids.erase(first, last);
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,297 @@
+/**
+   The Recording classes implement recording and replay of frames.
+*/
+
+// Include standard headers.
+#include <cstdio>
+#include <cstring>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Magic bytes identifying a recording, and version of the format.
+const char MAGIC[8] = { 'S', 'H', 'R', 'L', 'R', 'E', 'C', 'D' };
+const int32_t FORMAT_VERSION = 1;
+
+// Microseconds since the Unix epoch of given time, and back.
+int64_t toMicrosec(const boost::posix_time::ptime& tstamp)
+{
+    static const boost::posix_time::ptime epoch (boost::gregorian::date(1970, 1, 1));
+    return (tstamp - epoch).total_microseconds();
+}
+
+boost::posix_time::ptime fromMicrosec(const int64_t& microsec)
+{
+    static const boost::posix_time::ptime epoch (boost::gregorian::date(1970, 1, 1));
+    return epoch + boost::posix_time::microseconds(microsec);
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast <const char*> (&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value)
+{
+    return (bool)file.read(reinterpret_cast <char*> (&value), sizeof(value));
+}
+
+// Largest JPEG image of an MJPEG video (beyond which
+// the markers found are taken to be spurious.)
+const size_t MAX_JPEG = 1 << 26;
+
+// Skip past the next JPEG start-of-image marker
+// (followed by another marker.)
+bool skipToImage(std::ifstream& file)
+{
+    int previous = 0;
+    int letter;
+    while ((letter = file.get()) != EOF)
+    {
+        if (previous == 0xFF && letter == 0xD8 && file.peek() == 0xFF)
+        {
+            return true;
+        }
+        previous = letter;
+    }
+    return false;
+}
+
+// Read the JPEG image following a start-of-image marker (through
+// its end-of-image marker) into *buffer*, segment by segment, so
+// that markers within segments (e.g. of an embedded thumbnail) are
+// not taken for those of the image.
+// Return false if not a well-formed image.
+bool readImage(std::ifstream& file, std::vector <uchar>& buffer)
+{
+    buffer.assign({ 0xFF, 0xD8 });
+    int code = file.get();
+    while (buffer.size() < MAX_JPEG)
+    {
+        // A marker (after any fill bytes), standalone or
+        // followed by the length of its segment.
+        if (code != 0xFF)
+        {
+            return false;
+        }
+        while ((code = file.get()) == 0xFF)
+        {
+            continue;
+        }
+        if (code == EOF || code == 0x00 || code == 0xD8 || code == 0xD9)
+        {
+            return false;
+        }
+        buffer.push_back(0xFF);
+        buffer.push_back(code);
+        if (code == 0x01 || (code >= 0xD0 && code <= 0xD7))
+        {
+            code = file.get();
+            continue;
+        }
+        int high = file.get();
+        int low = file.get();
+        int length = (high << 8) | low;
+        if (low == EOF || high == EOF || length < 2)
+        {
+            return false;
+        }
+        buffer.push_back(high);
+        buffer.push_back(low);
+        size_t offset = buffer.size();
+        buffer.resize(offset + length - 2);
+        if (!file.read(reinterpret_cast <char*> (buffer.data() + offset), length - 2))
+        {
+            return false;
+        }
+        if (code != 0xDA)
+        {
+            code = file.get();
+            continue;
+        }
+
+        // The entropy-coded data of a scan runs up to the next marker
+        // (stuffed zero bytes and restart markers being part of it.)
+        while (buffer.size() < MAX_JPEG)
+        {
+            code = file.get();
+            if (code == EOF)
+            {
+                return false;
+            }
+            if (code != 0xFF)
+            {
+                buffer.push_back(code);
+                continue;
+            }
+            int next = file.peek();
+            if (next == 0x00 || (next >= 0xD0 && next <= 0xD7))
+            {
+                buffer.push_back(0xFF);
+                buffer.push_back(file.get());
+                continue;
+            }
+            if (next == 0xD9)
+            {
+                file.get();
+                buffer.push_back(0xFF);
+                buffer.push_back(0xD9);
+                return true;
+            }
+            if (next != 0xFF)
+            {
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+}  // namespace.
+
+bool RecordingWriter::open(const std::string& fname)
+{
+    m_file.open(fname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    m_start = boost::posix_time::not_a_date_time;
+    m_count = 0;
+    return m_file.is_open();
+}
+
+
+void RecordingWriter::write(
+    const cv::Mat& frame,
+    const boost::posix_time::ptime& tstamp)
+{
+    // The header is written with the first frame,
+    // which sets the start time of the recording.
+    if (m_start.is_not_a_date_time())
+    {
+        m_start = tstamp;
+        m_file.write(MAGIC, sizeof(MAGIC));
+        writeValue(m_file, FORMAT_VERSION);
+        writeValue(m_file, toMicrosec(m_start));
+    }
+
+    // PNG at the lowest compression level is lossless, yet fast
+    // enough to keep up with capture.
+    std::vector <uchar> buffer;
+    cv::imencode(".png", frame, buffer, { CV_IMWRITE_PNG_COMPRESSION, 1 });
+    writeValue(m_file, (int64_t)(tstamp - m_start).total_microseconds());
+    writeValue(m_file, (uint32_t)buffer.size());
+    m_file.write(reinterpret_cast <const char*> (buffer.data()), buffer.size());
+    m_file.flush();
+    ++m_count;
+}
+
+
+bool RecordingReader::open(const std::string& fname)
+{
+    m_file.open(fname.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    int32_t version;
+    int64_t start;
+    if (!m_file.read(magic, sizeof(magic))
+        || memcmp(magic, MAGIC, sizeof(magic)) != 0
+        || !readValue(m_file, version)
+        || version != FORMAT_VERSION
+        || !readValue(m_file, start))
+    {
+        m_file.close();
+        return false;
+    }
+    m_start = fromMicrosec(start);
+    return true;
+}
+
+
+bool RecordingReader::read(cv::Mat& frame, boost::posix_time::ptime& tstamp)
+{
+    return readEncoded(m_buffer, tstamp) && decode(m_buffer, frame);
+}
+
+
+bool RecordingReader::readEncoded(
+    std::vector <uchar>& buffer,
+    boost::posix_time::ptime& tstamp)
+{
+    int64_t offset;
+    uint32_t size;
+    if (!m_file.is_open() || !readValue(m_file, offset) || !readValue(m_file, size))
+    {
+        return false;
+    }
+    buffer.resize(size);
+    if (!m_file.read(reinterpret_cast <char*> (buffer.data()), size))
+    {
+        return false;
+    }
+    tstamp = m_start + boost::posix_time::microseconds(offset);
+    return true;
+}
+
+
+bool RecordingReader::decode(const std::vector <uchar>& buffer, cv::Mat& frame)
+{
+    // Decode into the frame's own buffer (from the matrix pool,
+    // if attached), rather than a newly allocated one.
+    cv::imdecode(buffer, -1, &frame);  // Unchanged (as encoded.)
+    return !frame.empty();
+}
+
+
+bool MjpegReader::open(
+    const std::string& fname,
+    const boost::posix_time::ptime& start,
+    const double& fps)
+{
+    if (!(fps > 0))
+    {
+        return false;
+    }
+    m_file.open(fname.c_str(), std::ios::in | std::ios::binary);
+    m_start = start;
+    m_interval = 1e6 / fps;
+    m_count = 0;
+    return m_file.is_open();
+}
+
+
+bool MjpegReader::readEncoded(
+    std::vector <uchar>& buffer,
+    boost::posix_time::ptime& tstamp)
+{
+    // Container data between images is skipped, as are
+    // markers found in it not starting a whole image.
+    while (m_file.is_open() && skipToImage(m_file))
+    {
+        auto start = m_file.tellg();
+        if (readImage(m_file, buffer))
+        {
+            tstamp = m_start + boost::posix_time::microseconds(
+                (int64_t)(m_count++ * m_interval));
+            return true;
+        }
+        if (m_file.eof())
+        {
+            return false;
+        }
+        m_file.clear();
+        m_file.seekg(start);
+    }
+    return false;
+}
+
+
+bool MjpegReader::decode(const std::vector <uchar>& buffer, cv::Mat& frame)
+{
+    cv::imdecode(buffer, 1, &frame);  // Color (as VideoCapture decodes.)
+    return !frame.empty();
+}
+
+}  // namespace sherlock.
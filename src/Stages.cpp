@@ -0,0 +1,107 @@
+/**
+   Pipeline stages of the capture and display tools.
+*/
+
+// Include standard headers.
+#include <iomanip>
+#include <sstream>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+Capture::Capture(const StageOptions& options) :
+    m_cap      (options.device),
+    m_duration (options.duration),
+    m_pacer    (options.max_fps),
+    m_started  (false)
+{
+    m_cap.set(3, options.width);
+    m_cap.set(4, options.height);
+}
+
+
+bool Capture::process(Frame& frame)
+{
+    // Capture for the given duration from the first frame on.
+    if (!m_started)
+    {
+        m_end = Pacer::now() + std::chrono::microseconds((long)(m_duration*1e6));
+        m_started = true;
+    }
+    if (Pacer::now() >= m_end)
+    {
+        m_pacer.report(std::cout);
+        return false;
+    }
+
+    // Wait for the frame's deadline, to observe maximum framerate limit.
+    m_pacer.wait();
+    m_cap >> frame.image;
+    frame.alpha = getAlpha(m_tstamp_prev, 1.0);
+    return !frame.image.empty();
+}
+
+
+DiffAverage::DiffAverage(const StageOptions&)
+{
+    // Temporaries are reused from frame to frame.
+    MatPool::attach(m_converted);
+    MatPool::attach(m_diff);
+}
+
+
+bool DiffAverage::process(Frame& frame)
+{
+    const auto RTYPE = CV_32FC3;
+
+    // Initalize accumulation if so indicated.
+    if (m_average.empty())
+    {
+        m_average = cv::Mat::zeros(frame.image.size(), frame.image.type());
+        m_average.convertTo(m_average, RTYPE);
+    }
+
+    // Compute difference.
+    frame.image.convertTo(m_converted, RTYPE);
+    cv::absdiff(m_average, m_converted, m_diff);
+
+    // Accumulate.
+    cv::accumulateWeighted(m_converted, m_average, frame.alpha);
+
+    // Replace the frame with the difference
+    // (converted into the frame's own buffer.)
+    m_diff.convertTo(frame.image, frame.image.type());
+    return true;
+}
+
+
+bool RateOSD::process(Frame& frame)
+{
+    auto fps = m_ticker.tick();
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2);
+    line << fps[0] << ", " << fps[1] << ", " << fps[2] << " (" << m_label << ")";
+    frame.osd.push_back(line.str());
+    return true;
+}
+
+
+bool Display::process(Frame& frame)
+{
+    // Create the window on the displaying thread.
+    if (!m_created)
+    {
+        cv::namedWindow(m_title, CV_WINDOW_NORMAL);
+        m_created = true;
+    }
+    writeOSD(frame.image, frame.osd, 0.04);
+    cv::imshow(m_title, frame.image);
+
+    // Allow HighGUI to process event.
+    cv::waitKey(1);
+    return true;
+}
+
+}  // namespace sherlock.
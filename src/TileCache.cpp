@@ -0,0 +1,126 @@
+/**
+   The TileCache class implements caching of detection results
+   over the tiles of a static scene.
+*/
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+TileCache::TileCache() :
+    m_params        ({ 0, 0, 0, 0 }),
+    m_next_refresh  (0),
+    m_valid         (false),
+    m_frames        (0),
+    m_tiles         (0),
+    m_scanned_tiles (0)
+{/* Empty. */}
+
+
+void TileCache::setParameters(const Parameters& params)
+{
+    if (params.columns != m_params.columns || params.rows != m_params.rows
+        || params.threshold != m_params.threshold || params.refresh != m_params.refresh)
+    {
+        m_params = params;
+        m_valid = false;
+    }
+}
+
+
+void TileCache::update(const cv::Mat& gray, const std::vector <double>& scan)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    // Start over as the image or the scan changes
+    // (tiles are at least a pixel wide.)
+    if (!m_valid || gray.size() != m_size || scan != m_scan)
+    {
+        m_size = gray.size();
+        m_scan = scan;
+        m_grid = cv::Size(
+            std::min(m_params.columns, m_size.width),
+            std::min(m_params.rows, m_size.height));
+        m_tile = cv::Size(
+            (m_size.width + m_grid.width - 1) / m_grid.width,
+            (m_size.height + m_grid.height - 1) / m_grid.height);
+        m_grid = cv::Size(
+            (m_size.width + m_tile.width - 1) / m_tile.width,
+            (m_size.height + m_tile.height - 1) / m_tile.height);
+        m_signatures.create(m_grid.area(), SIGNATURE*SIGNATURE, CV_8U);
+        m_candidates.clear();
+        m_next_refresh = 0;
+    }
+    m_scanned.create(m_grid, CV_8U);
+
+    // Compare the signature of every tile with the one scanned last,
+    // scanning tiles that changed.
+    const cv::Size signature (SIGNATURE, SIGNATURE);
+    const int tiles = m_grid.area();
+    m_thumbnails.create(tiles, signature.area(), CV_8U);
+    for (int index = 0; index < tiles; ++index)
+    {
+        int row = index / m_grid.width, col = index % m_grid.width;
+        cv::Rect tile (col*m_tile.width, row*m_tile.height, m_tile.width, m_tile.height);
+        cv::Mat thumbnail = m_thumbnails.row(index).reshape(1, SIGNATURE);
+        cv::resize(gray(tile & cv::Rect(0, 0, m_size.width, m_size.height)),
+                   thumbnail, signature, 0, 0, CV_INTER_AREA);
+        m_scanned.at<uchar>(row, col) = !m_valid
+            || cv::norm(m_thumbnails.row(index), m_signatures.row(index), cv::NORM_L1)
+            / signature.area() > m_params.threshold;
+    }
+
+    // Refresh the next tiles in turn.
+    for (int ii = 0; ii < std::min(m_params.refresh, tiles); ++ii)
+    {
+        m_scanned.at<uchar>(m_next_refresh / m_grid.width, m_next_refresh % m_grid.width) = 1;
+        m_next_refresh = (m_next_refresh + 1) % tiles;
+    }
+
+    // Keep the signatures of the tiles scanned.
+    long scanned = 0;
+    for (int index = 0; index < tiles; ++index)
+    {
+        if (m_scanned.at<uchar>(index / m_grid.width, index % m_grid.width))
+        {
+            cv::Mat kept = m_signatures.row(index);
+            m_thumbnails.row(index).copyTo(kept);
+            ++scanned;
+        }
+    }
+    cv::integral(m_scanned, m_counts, CV_32S);
+    m_valid = true;
+
+    ++m_frames;
+    m_tiles += tiles;
+    m_scanned_tiles += scanned;
+}
+
+
+void TileCache::merge(std::vector <cv::Rect>& candidates)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    for (auto& candidate : m_candidates)
+    {
+        if (count(candidate) == 0)
+        {
+            candidates.push_back(candidate);
+        }
+    }
+    m_candidates = candidates;
+}
+
+
+TileCache::Stats TileCache::getStats() const
+{
+    return { m_frames, m_tiles, m_scanned_tiles };
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,243 @@
+/**
+   Span tracing, and its export as Chrome trace JSON.
+*/
+
+// Include standard headers.
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// Include system headers.
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+#ifdef SHERLOCK_TRACE
+
+namespace {
+
+// Number of spans kept per thread (a power of two.)
+const uint64_t CAPACITY = 1 << 14;
+
+// A span recorded (times in nanoseconds of the steady clock.)
+struct Record
+{
+    const char* name;
+    const void* frame;
+    bool first;
+    int64_t begin;
+    int64_t end;
+};
+
+// The spans of a thread: written by the thread only, the head
+// (number of spans ever written) published after every span.
+struct Ring
+{
+    std::string thread;
+    int tid;
+    std::atomic <uint64_t> head;
+    Record records[CAPACITY];
+};
+
+// All rings (of threads running or exited), and names interned,
+// kept for the whole run.
+struct Registry
+{
+    std::mutex mutex;
+    std::vector <std::unique_ptr <Ring>> rings;
+    std::set <std::string> names;
+};
+
+Registry& registry()
+{
+    static auto instance = new Registry;
+    return *instance;
+}
+
+// Return the ring of the calling thread (created on first use.)
+Ring& threadRing()
+{
+    thread_local Ring* ring = NULL;
+    if (!ring)
+    {
+        auto& reg = registry();
+        std::lock_guard <std::mutex> locker (reg.mutex);
+        reg.rings.push_back(std::unique_ptr <Ring> (new Ring));
+        ring = reg.rings.back().get();
+        ring->tid = reg.rings.size();
+        ring->thread = "thread " + std::to_string(ring->tid);
+        ring->head = 0;
+    }
+    return *ring;
+}
+
+int64_t nanoseconds(const std::chrono::steady_clock::time_point& time)
+{
+    return std::chrono::duration_cast <std::chrono::nanoseconds> (
+        time.time_since_epoch()).count();
+}
+
+// Write a JSON string (names are plain, but quoted just in case.)
+void writeString(std::ostream& out, const std::string& text)
+{
+    out << '"';
+    for (auto letter : text)
+    {
+        if (letter == '"' || letter == '\\') out << '\\';
+        out << letter;
+    }
+    out << '"';
+}
+
+}  // namespace.
+
+
+Span::~Span()
+{
+    auto& ring = threadRing();
+    auto head = ring.head.load(std::memory_order_relaxed);
+    ring.records[head & (CAPACITY - 1)] = {
+        m_name, m_frame, m_first,
+        nanoseconds(m_begin), nanoseconds(std::chrono::steady_clock::now()) };
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+
+void Trace::setThreadName(const std::string& name)
+{
+    auto& ring = threadRing();
+    std::lock_guard <std::mutex> locker (registry().mutex);
+    ring.thread = name;
+}
+
+
+const char* Trace::intern(const std::string& name)
+{
+    auto& reg = registry();
+    std::lock_guard <std::mutex> locker (reg.mutex);
+    return reg.names.insert(name).first->c_str();
+}
+
+
+bool Trace::isEnabled()
+{
+    return true;
+}
+
+
+long Trace::write(std::ostream& out)
+{
+    // Copy the spans of every thread, keeping those not
+    // overwritten while being copied.
+    struct Copied
+    {
+        Record record;
+        Ring* ring;
+    };
+    std::vector <Copied> spans;
+    std::vector <std::pair <int, std::string>> threads;
+    {
+        auto& reg = registry();
+        std::lock_guard <std::mutex> locker (reg.mutex);
+        for (auto& ring : reg.rings)
+        {
+            threads.push_back({ ring->tid, ring->thread });
+            auto head = ring->head.load(std::memory_order_acquire);
+            auto begin = head > CAPACITY ? head - CAPACITY : 0;
+            std::vector <Record> records;
+            for (auto index = begin; index < head; ++index)
+            {
+                records.push_back(ring->records[index & (CAPACITY - 1)]);
+            }
+            // The owner may be writing the record at the current head,
+            // over the slot of the oldest one still counted in.
+            auto overwritten = ring->head.load(std::memory_order_acquire);
+            overwritten = overwritten >= CAPACITY ? overwritten - CAPACITY + 1 : 0;
+            for (auto index = std::max(begin, overwritten); index < head; ++index)
+            {
+                spans.push_back({ records[index - begin], ring.get() });
+            }
+        }
+    }
+
+    // Number the frames in order of their first spans' ends (frames
+    // are known to a span by its end), and tag every span with the
+    // latest frame numbered at the address of its frame (addresses
+    // are reused by later frames.)
+    std::sort(spans.begin(), spans.end(), [](const Copied& a, const Copied& b) {
+            return a.record.end < b.record.end; });
+    std::map <const void*, long> numbers;
+    long count = 0;
+    int64_t origin = spans.empty() ? 0 : spans.front().record.begin;
+    for (auto& span : spans)
+    {
+        origin = std::min(origin, span.record.begin);
+    }
+    int pid = getpid();
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (auto& thread : threads)
+    {
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << thread.first << ",\"args\":{\"name\":";
+        writeString(out, thread.second);
+        out << "}}";
+        first = false;
+    }
+    for (auto& span : spans)
+    {
+        auto& record = span.record;
+        if (record.first)
+        {
+            numbers[record.frame] = count++;
+        }
+        out << (first ? "" : ",\n") << "{\"name\":";
+        writeString(out, record.name);
+        out << ",\"cat\":\"sherlock\",\"ph\":\"X\",\"pid\":" << pid
+            << ",\"tid\":" << span.ring->tid
+            << ",\"ts\":" << (record.begin - origin) / 1000.
+            << ",\"dur\":" << (record.end - record.begin) / 1000.;
+        auto number = numbers.find(record.frame);
+        if (record.frame && number != numbers.end())
+        {
+            out << ",\"args\":{\"frame\":" << number->second << "}";
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return spans.size();
+}
+
+#else
+
+long Trace::write(std::ostream& out)
+{
+    out << "{\"traceEvents\":[]}\n";
+    return 0;
+}
+
+#endif  // SHERLOCK_TRACE
+
+
+bool Trace::save(const std::string& fname)
+{
+    std::ofstream file (fname.c_str());
+    if (!file)
+    {
+        return false;
+    }
+    write(file);
+    return (bool)file;
+}
+
+}  // namespace sherlock.
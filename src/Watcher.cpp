@@ -0,0 +1,118 @@
+// Include standard headers.
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+
+// Include system headers.
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Include 3rd party headers.
+#include <boost/filesystem.hpp>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Time (in milliseconds) to wait for a burst of changes to settle,
+// so that a partially written file is not acted upon.
+const int SETTLE_MSEC = 200;
+
+}  // namespace.
+
+Watcher::Watcher(
+    const std::string& fname,
+    std::function <void (void)> on_change
+    ) :
+    m_fname     (fname),
+    m_on_change (on_change),
+    m_stop_fd   (eventfd(0, EFD_CLOEXEC))
+{/* Empty. */}
+
+
+Watcher::~Watcher()
+{
+    if (m_stop_fd >= 0)
+    {
+        close(m_stop_fd);
+    }
+}
+
+
+void Watcher::stop()
+{
+    uint64_t one = 1;
+    if (m_stop_fd >= 0 && write(m_stop_fd, &one, sizeof(one)) < 0)
+    {
+        std::cout << "Warning: Failed to stop watching " << m_fname << std::endl;
+    }
+}
+
+
+void Watcher::run()
+{
+    // Watch the directory rather than the file itself,
+    // since the file may be replaced by another one.
+    auto path = boost::filesystem::absolute(m_fname);
+    auto dir = path.parent_path().string();
+    auto name = path.filename().string();
+    int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (fd < 0 || m_stop_fd < 0
+        || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        std::cout << "Warning: Cannot watch " << m_fname << std::endl;
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    bool changed = false;
+    while (true)
+    {
+        // Wait for events (or for pending changes to settle.)
+        struct pollfd fds[2] = {
+            { m_stop_fd, POLLIN, 0 },
+            { fd, POLLIN, 0 },
+        };
+        int count = poll(fds, 2, changed ? SETTLE_MSEC : -1);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0 || fds[0].revents)
+        {
+            break;
+        }
+
+        // Settled after changes.
+        if (count == 0)
+        {
+            changed = false;
+            m_on_change();
+            continue;
+        }
+
+        // Look for events concerning the watched file.
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* ptr = buffer; ptr < buffer + length; )
+            {
+                auto event = reinterpret_cast <struct inotify_event*> (ptr);
+                if (event->len && name == event->name)
+                {
+                    changed = true;
+                }
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+    close(fd);
+}
+
+}  // namespace sherlock.
@@ -0,0 +1,208 @@
+// Benchmark the native cascade evaluator (alone and batched) against OpenCV.
+
+// Include standard headers.
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Include 3rd party headers.
+#include <boost/date_time.hpp>
+#include <opencv2/opencv.hpp>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace {
+
+// Order rectangles, for comparing detections regardless of order.
+bool lessRect(const cv::Rect& a, const cv::Rect& b)
+{
+    if (a.x != b.x) return a.x < b.x;
+    if (a.y != b.y) return a.y < b.y;
+    if (a.width != b.width) return a.width < b.width;
+    return a.height < b.height;
+}
+
+// Return elapsed milliseconds since *start*.
+double elapsedMsec(const boost::posix_time::ptime& start)
+{
+    auto now = boost::posix_time::microsec_clock::universal_time();
+    return (now - start).total_microseconds() / 1000.;
+}
+
+// A classifier run by both engines.
+struct Subject
+{
+    sherlock::ClassifierEntry entry;
+    sherlock::Cascade cascade;
+    cv::CascadeClassifier cv_classifier;
+    int mismatches;
+    int detections;
+};
+
+}  // namespace.
+
+int main(int argc, char** argv)
+{
+    // Parse command-line arguments.
+    // The source is either a device index or a video file name.
+    if (argc < 5)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " DEVICE|FILE WIDTH HEIGHT FRAMES [CONFIG]" << std::endl;
+        return 1;
+    }
+    std::string SOURCE (argv[1]);
+    int WIDTH, HEIGHT, FRAMES;
+    std::string CONFIG_FNAME ("conf/classifiers.conf");
+    std::istringstream(std::string(argv[2])) >> WIDTH;
+    std::istringstream(std::string(argv[3])) >> HEIGHT;
+    std::istringstream(std::string(argv[4])) >> FRAMES;
+    if (argc > 5) std::istringstream(std::string(argv[5])) >> CONFIG_FNAME;
+
+    // Create the OpenCV video capture object.
+    cv::VideoCapture cap;
+    if (SOURCE.find_first_not_of("0123456789") == std::string::npos)
+    {
+        cap.open(atoi(SOURCE.c_str()));
+        cap.set(3, WIDTH);
+        cap.set(4, HEIGHT);
+    }
+    else
+    {
+        cap.open(SOURCE);
+    }
+
+    // Load every classifier with both engines.
+    sherlock::ClassifierSettings settings;
+    std::vector <Subject*> subjects;
+    for (auto entry : sherlock::readClassifierConfig(CONFIG_FNAME, settings))
+    {
+        auto subject = new Subject;
+        subject->entry = entry;
+        subject->mismatches = 0;
+        subject->detections = 0;
+        if (!subject->cascade.load(entry.fname, settings.cache_dir)
+            || !subject->cv_classifier.load(entry.fname))
+        {
+            std::cout << "Skipping " << entry.fname
+                      << " (not supported by both engines)" << std::endl;
+            delete subject;
+            continue;
+        }
+        subjects.push_back(subject);
+    }
+    if (subjects.empty())
+    {
+        std::cout << "No classifiers to benchmark." << std::endl;
+        return 1;
+    }
+
+    // Run both engines on every frame, timing each.
+    double cv_msec = 0, native_msec = 0, batch_msec = 0;
+    int frames = 0;
+    for (; frames < FRAMES; ++frames)
+    {
+        cv::Mat frame;
+        cap >> frame;
+        if (frame.empty())
+        {
+            break;
+        }
+
+        std::vector <std::vector <cv::Rect>> cv_rects (subjects.size());
+        auto start = boost::posix_time::microsec_clock::universal_time();
+        for (size_t ii = 0; ii < subjects.size(); ++ii)
+        {
+            auto& params = subjects[ii]->entry.params;
+            subjects[ii]->cv_classifier.detectMultiScale(
+                frame,
+                cv_rects[ii],
+                params.scale_factor,
+                params.min_neighbors,
+                0,
+                cv::Size(frame.cols*params.min_size_ratio, frame.rows*params.min_size_ratio),
+                cv::Size(frame.cols*params.max_size_ratio, frame.rows*params.max_size_ratio));
+        }
+        cv_msec += elapsedMsec(start);
+
+        // Native evaluators share the frame's pyramid
+        // (building it is included in the timing.)
+        std::vector <std::vector <cv::Rect>> native_rects (subjects.size());
+        start = boost::posix_time::microsec_clock::universal_time();
+        sherlock::PyramidCache pyramids;
+        for (size_t ii = 0; ii < subjects.size(); ++ii)
+        {
+            auto& params = subjects[ii]->entry.params;
+            sherlock::Evaluator evaluator (subjects[ii]->cascade);
+            evaluator.detectMultiScale(
+                *pyramids.get(&frame, params.scale_factor),
+                native_rects[ii],
+                params.min_neighbors,
+                cv::Size(frame.cols*params.min_size_ratio, frame.rows*params.min_size_ratio),
+                cv::Size(frame.cols*params.max_size_ratio, frame.rows*params.max_size_ratio));
+        }
+        native_msec += elapsedMsec(start);
+
+        // Batched evaluators sweep each pyramid once
+        // (scale factors are assumed to be all the same.)
+        std::vector <std::vector <cv::Rect>> batch_rects;
+        start = boost::posix_time::microsec_clock::universal_time();
+        {
+            sherlock::PyramidCache pyramids;
+            std::vector <sherlock::Evaluator*> evaluators;
+            std::vector <sherlock::Evaluator::Limits> limits;
+            for (auto subject : subjects)
+            {
+                auto& params = subject->entry.params;
+                evaluators.push_back(new sherlock::Evaluator(subject->cascade));
+                limits.push_back({
+                    params.min_neighbors,
+                    cv::Size(frame.cols*params.min_size_ratio, frame.rows*params.min_size_ratio),
+                    cv::Size(frame.cols*params.max_size_ratio, frame.rows*params.max_size_ratio)});
+            }
+            sherlock::Evaluator::detectBatch(
+                *pyramids.get(&frame, subjects[0]->entry.params.scale_factor),
+                evaluators, limits, batch_rects);
+            for (auto evaluator : evaluators)
+            {
+                delete evaluator;
+            }
+        }
+        batch_msec += elapsedMsec(start);
+
+        // Compare the detections.
+        for (size_t ii = 0; ii < subjects.size(); ++ii)
+        {
+            std::sort(cv_rects[ii].begin(), cv_rects[ii].end(), lessRect);
+            std::sort(native_rects[ii].begin(), native_rects[ii].end(), lessRect);
+            std::sort(batch_rects[ii].begin(), batch_rects[ii].end(), lessRect);
+            subjects[ii]->detections += cv_rects[ii].size();
+            if (cv_rects[ii] != native_rects[ii] || cv_rects[ii] != batch_rects[ii])
+            {
+                subjects[ii]->mismatches++;
+            }
+        }
+    }
+
+    // Report the results.
+    std::cout << std::fixed << std::setprecision(2);
+    for (auto subject : subjects)
+    {
+        std::cout << subject->entry.fname << ": "
+                  << subject->detections << " detections, "
+                  << subject->mismatches << " of " << frames
+                  << " frames differ" << std::endl;
+        delete subject;
+    }
+    if (frames > 0)
+    {
+        std::cout << cv_msec / frames << " msec/frame (OpenCV)" << std::endl;
+        std::cout << native_msec / frames << " msec/frame (native)" << std::endl;
+        std::cout << batch_msec / frames << " msec/frame (batch)" << std::endl;
+        std::cout << cv_msec / std::max(native_msec, 1e-3) << "x speedup (native)" << std::endl;
+        std::cout << cv_msec / std::max(batch_msec, 1e-3) << "x speedup (batch)" << std::endl;
+    }
+}
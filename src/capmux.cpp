@@ -0,0 +1,120 @@
+/**
+   Capture from many sources on a few threads.
+*/
+
+// Include standard headers.
+#include <csignal>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+namespace {
+
+// The multiplexers running (for stopping on signals.)
+std::vector <sherlock::Multiplexer*> multiplexers;
+
+// Stop capture on interrupt or termination.
+void onSignal(int)
+{
+    for (auto multiplexer : multiplexers)
+    {
+        multiplexer->stop();
+    }
+}
+
+}  // namespace.
+
+int main(int argc, char** argv)
+{
+    // Separate the options from the positional arguments.
+    int THREADS = 1;
+    std::vector <std::string> args;
+    for (int ii = 1; ii < argc; ++ii)
+    {
+        std::string arg (argv[ii]);
+        if (arg == "--threads" && ii + 1 < argc) std::istringstream(argv[++ii]) >> THREADS;
+        else args.push_back(arg);
+    }
+    if (args.size() < 5 || THREADS < 1)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " [--threads N] WIDTH HEIGHT DURATION MAX_FPS SOURCE..." << std::endl;
+        std::cout << "A SOURCE is a V4L2 device (/dev/video*), or a file or pipe"
+                  << " of raw BGR frames (- for standard input.)" << std::endl;
+        std::cout << "A DURATION of 0 runs until interrupted"
+                  << " (or until all sources end.)" << std::endl;
+        return 1;
+    }
+
+    // Parse command-line arguments.
+    int WIDTH, HEIGHT, DURATION;
+    float MAX_FPS;
+    std::istringstream(args[0]) >> WIDTH;
+    std::istringstream(args[1]) >> HEIGHT;
+    std::istringstream(args[2]) >> DURATION;
+    std::istringstream(args[3]) >> MAX_FPS;
+    std::vector <std::string> SOURCES (args.begin() + 4, args.end());
+
+    // All sources push onto one queue, consumed here.
+    sherlock::EdgePolicy policy;
+    policy.capacity = SOURCES.size();
+    sherlock::Edge <cv::Mat*> frames (policy);
+    frames.setDropCallback([](cv::Mat* const& frame) { delete frame; });
+
+    // Distribute the sources between the multiplexers.
+    std::vector <std::unique_ptr <sherlock::Multiplexer>> owned;
+    for (int ii = 0; ii < THREADS && ii < (int)SOURCES.size(); ++ii)
+    {
+        owned.push_back(std::unique_ptr <sherlock::Multiplexer> (
+            new sherlock::Multiplexer(DURATION)));
+        multiplexers.push_back(owned.back().get());
+    }
+    for (size_t ii = 0; ii < SOURCES.size(); ++ii)
+    {
+        auto& name = SOURCES[ii];
+        sherlock::FrameSource* source;
+        if (name.compare(0, 10, "/dev/video") == 0)
+        {
+            source = new sherlock::V4L2Source(name, WIDTH, HEIGHT, MAX_FPS);
+        }
+        else
+        {
+            source = new sherlock::RawSource(name, WIDTH, HEIGHT, MAX_FPS);
+        }
+        source->addOutput(frames);
+        multiplexers[ii % multiplexers.size()]->addSource(source);
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    for (auto multiplexer : multiplexers)
+    {
+        multiplexer->start();
+    }
+
+    // Consume frames until every source has ended.
+    size_t ended = 0;
+    while (ended < SOURCES.size())
+    {
+        cv::Mat* frame;
+        frames.wait_and_pop(frame);
+        if (!frame)
+        {
+            ++ended;
+        }
+        delete frame;
+    }
+    for (auto multiplexer : multiplexers)
+    {
+        multiplexer->join();
+        multiplexer->report(std::cout);
+    }
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    multiplexers.clear();
+    std::cout << "Queue of frames: " << frames.getCounters() << std::endl;
+}
@@ -0,0 +1,424 @@
+/*!
+  Classifier configuration file reading.
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <bites.hpp>
+
+#include "sherlock.hpp"
+
+namespace sherlock {
+
+namespace {
+
+// Configuration keys which are settings (rather than classifiers.)
+const std::vector <std::string> SETTINGS = {
+    "SCALE_FACTOR",
+    "MIN_NEIGHBORS",
+    "MIN_SIZE_RATIO",
+    "MAX_SIZE_RATIO",
+    "DIRS",
+    "CACHE_DIR",
+    "ENGINE",
+    "DISPLAY_POLICY",
+    "DISPLAY_WIDTH",
+    "CLASSIFIER_POLICY",
+    "FUSION",
+    "CAPTURE_PLACEMENT",
+    "CLASSIFIER_PLACEMENT",
+    "DISPLAY_PLACEMENT",
+    "RESOLUTION",
+    "TILE_CACHE",
+    "EXCLUDE",
+};
+
+// Prefix of configuration keys of processing graph stages.
+const std::string STAGE_PREFIX = "STAGE_";
+
+// Prefix of configuration keys of exclusion masks of sources.
+const std::string EXCLUDE_PREFIX = "EXCLUDE_";
+
+// Parse a detection resolution: "auto", "full" or a scale in (0, 1].
+bool parseResolution(const std::string& spec, float& resolution)
+{
+    if (spec == "auto")
+    {
+        resolution = Classifier::AUTO_RESOLUTION;
+        return true;
+    }
+    if (spec == "full")
+    {
+        resolution = 1;
+        return true;
+    }
+    std::istringstream tokens (spec);
+    float scale;
+    if (!(tokens >> scale) || !tokens.eof() || scale <= 0 || scale > 1)
+    {
+        return false;
+    }
+    resolution = scale;
+    return true;
+}
+
+// Parse the overload policy of given setting, if present.
+void readPolicy(
+    bites::Config& config,
+    const std::vector <std::string>& keys,
+    const std::string& key,
+    EdgePolicy& policy)
+{
+    if (std::find(keys.begin(), keys.end(), key) == keys.end())
+    {
+        return;
+    }
+    if (!parseEdgePolicy(config[key], policy))
+    {
+        std::cout << "Warning: Invalid " << key << " \"" << config[key]
+                  << "\" (using the default)" << std::endl;
+    }
+}
+
+// Parse the thread placement of given setting, if present.
+void readPlacement(
+    bites::Config& config,
+    const std::vector <std::string>& keys,
+    const std::string& key,
+    Placement& placement)
+{
+    placement = Placement();
+    if (std::find(keys.begin(), keys.end(), key) == keys.end())
+    {
+        return;
+    }
+    if (!parsePlacement(config[key], placement))
+    {
+        std::cout << "Warning: Invalid " << key << " \"" << config[key]
+                  << "\" (using the default)" << std::endl;
+    }
+}
+
+// Read the processing graph from the STAGE_ settings, if any (building
+// the default one from the other settings otherwise), and have the other
+// settings follow the graph.
+void readGraph(
+    bites::Config& config,
+    const std::vector <std::string>& keys,
+    ClassifierSettings& settings)
+{
+    auto& graph = settings.graph;
+    graph = Graph();
+    for (auto& key : keys)
+    {
+        if (key.compare(0, STAGE_PREFIX.size(), STAGE_PREFIX) != 0)
+        {
+            continue;
+        }
+        GraphStage stage;
+        stage.name = key.substr(STAGE_PREFIX.size());
+        if (!parseGraphStage(config[key], stage))
+        {
+            std::cout << "Warning: Invalid " << key << " \"" << config[key]
+                      << "\" (ignored)" << std::endl;
+            continue;
+        }
+        graph.stages.push_back(stage);
+    }
+    std::string error;
+    if (!graph.stages.empty() && !checkGraph(graph, error))
+    {
+        std::cout << "Warning: Invalid graph (" << error
+                  << "), using the default" << std::endl;
+        graph = Graph();
+    }
+
+    // By default, capture feeds the display and the classifiers
+    // (or the batch), whose detections are displayed (fused, if so
+    // configured.)
+    if (graph.stages.empty())
+    {
+        auto add = [&graph](const std::string& name, const GraphStage::Kind& kind) {
+            GraphStage stage;
+            stage.name = name;
+            stage.kind = kind;
+            graph.stages.push_back(stage);
+        };
+        add("capture", GraphStage::CAPTURE);
+        add("display", GraphStage::DISPLAY);
+        if (settings.batch)
+        {
+            add("batch", GraphStage::BATCH);
+        }
+        else
+        {
+            add("classifiers", GraphStage::CLASSIFIERS);
+        }
+        if (settings.fusion)
+        {
+            add("fusion", GraphStage::FUSION);
+        }
+        checkGraph(graph, error);
+    }
+
+    // Stages lacking policies or placements take those of the
+    // other settings (the display's also applies to fusion.)
+    for (auto& stage : graph.stages)
+    {
+        EdgePolicy policy = settings.classifier_policy;
+        Placement placement = settings.classifier_placement;
+        if (stage.kind == GraphStage::CAPTURE)
+        {
+            placement = settings.capture_placement;
+        }
+        if (stage.kind == GraphStage::DISPLAY || stage.kind == GraphStage::FUSION)
+        {
+            policy = settings.display_policy;
+            placement = settings.display_placement;
+        }
+        if (!stage.has_policy)
+        {
+            stage.policy = policy;
+        }
+        if (!stage.has_placement)
+        {
+            stage.placement = placement;
+        }
+    }
+
+    // The other settings follow the graph.
+    auto display = graph.find(GraphStage::DISPLAY);
+    auto classifiers = graph.find(GraphStage::CLASSIFIERS);
+    auto batch = graph.find(GraphStage::BATCH);
+    auto detection = classifiers ? classifiers : batch;
+    settings.batch = batch != NULL;
+    settings.fusion = graph.find(GraphStage::FUSION) != NULL;
+    settings.capture_placement = graph.find(GraphStage::CAPTURE)->placement;
+    settings.classifier_policy = detection->policy;
+    settings.classifier_placement = detection->placement;
+    if (display)
+    {
+        settings.display_policy = display->policy;
+        settings.display_placement = display->placement;
+    }
+}
+
+}  // namespace.
+
+std::vector <ClassifierEntry> readClassifierConfig(
+    const std::string& config_fname,
+    ClassifierSettings& settings,
+    const std::string& source)
+{
+    // Load the configuration file.
+    bites::Config config (config_fname);
+    auto keys = config.keys();
+    auto has = [&keys](const std::string& key) {
+        return std::find(keys.begin(), keys.end(), key) != keys.end();
+    };
+
+    // Compiled cascades are cached in CACHE_DIR, if configured.
+    settings.cache_dir = has("CACHE_DIR") ? config["CACHE_DIR"] : Cascade::defaultCacheDir();
+
+    // Detection runs on OpenCV unless the native ENGINE is selected;
+    // the batch engine is the native one, with classifiers batched.
+    std::string engine = has("ENGINE") ? config["ENGINE"] : "opencv";
+    settings.batch = engine == "batch";
+
+    // Overload policies of the display and classifier queues.
+    settings.display_policy = EdgePolicy();
+    settings.classifier_policy = EdgePolicy();
+    readPolicy(config, keys, "DISPLAY_POLICY", settings.display_policy);
+    readPolicy(config, keys, "CLASSIFIER_POLICY", settings.classifier_policy);
+
+    // Frames are displayed at most DISPLAY_WIDTH wide, if set.
+    settings.display_width = 0;
+    if (has("DISPLAY_WIDTH"))
+    {
+        std::stringstream(config["DISPLAY_WIDTH"]) >> settings.display_width;
+    }
+
+    // Detections are fused across classifiers if FUSION is set,
+    // to the overlap threshold and (optionally) the number of votes.
+    settings.fusion = has("FUSION");
+    settings.fusion_params = Fuser::Parameters();
+    if (settings.fusion)
+    {
+        std::stringstream values(config["FUSION"]);
+        values >> settings.fusion_params.iou;
+        values >> settings.fusion_params.votes;
+        if (settings.fusion_params.iou <= 0 || settings.fusion_params.iou > 1)
+        {
+            std::cout << "Warning: Invalid FUSION \"" << config["FUSION"]
+                      << "\" (using the default)" << std::endl;
+            settings.fusion_params = Fuser::Parameters();
+        }
+    }
+
+    // Placements of pipeline threads.
+    readPlacement(config, keys, "CAPTURE_PLACEMENT", settings.capture_placement);
+    readPlacement(config, keys, "CLASSIFIER_PLACEMENT", settings.classifier_placement);
+    readPlacement(config, keys, "DISPLAY_PLACEMENT", settings.display_placement);
+
+    // Stages of the processing graph (the batch stage,
+    // if any, selecting the native engine.)
+    readGraph(config, keys, settings);
+    bool native = engine == "native" || engine == "batch" || settings.batch;
+
+    // Detection resolution of all classifiers (unless overridden.)
+    float resolution = 1;
+    if (has("RESOLUTION") && !parseResolution(config["RESOLUTION"], resolution))
+    {
+        std::cout << "Warning: Invalid RESOLUTION \"" << config["RESOLUTION"]
+                  << "\" (using full)" << std::endl;
+    }
+
+    // Results are cached over tiles of static scenes, if TILE_CACHE
+    // is set to the tiling, the threshold and (optionally) the number
+    // of tiles refreshed per frame.
+    TileCache::Parameters tiles = { 0, 0, 0, 0 };
+    if (has("TILE_CACHE"))
+    {
+        std::stringstream values(config["TILE_CACHE"]);
+        values >> tiles.columns >> tiles.rows >> tiles.threshold;
+        if (!(values >> tiles.refresh))
+        {
+            tiles.refresh = 1;
+        }
+        if (tiles.columns <= 0 || tiles.rows <= 0 || tiles.threshold < 0 || tiles.refresh < 0)
+        {
+            std::cout << "Warning: Invalid TILE_CACHE \"" << config["TILE_CACHE"]
+                      << "\" (not caching)" << std::endl;
+            tiles = { 0, 0, 0, 0 };
+        }
+    }
+
+    // Windows centered in areas of the source's view excluded by
+    // EXCLUDE_<SOURCE> (or by EXCLUDE, for any source) are not scanned.
+    std::shared_ptr <const ExclusionMask> exclusion;
+    std::string exclude_key = has(EXCLUDE_PREFIX + source) ? EXCLUDE_PREFIX + source : "EXCLUDE";
+    if (has(exclude_key))
+    {
+        auto mask = std::make_shared <ExclusionMask> ();
+        if (parseExclusionMask(config[exclude_key], *mask))
+        {
+            exclusion = mask;
+        }
+        else
+        {
+            std::cout << "Warning: Invalid " << exclude_key << " \"" << config[exclude_key]
+                      << "\" (not excluding)" << std::endl;
+        }
+    }
+
+    // Iterate the configuration entries.
+    std::vector <ClassifierEntry> entries;
+    for(auto fname : keys)
+    {
+        // Skip the settings 
+        // (only remainder of file is actual classifier listing.)
+        if(std::find(SETTINGS.begin(), SETTINGS.end(), fname) != SETTINGS.end()
+           || fname.compare(0, STAGE_PREFIX.size(), STAGE_PREFIX) == 0
+           || fname.compare(0, EXCLUDE_PREFIX.size(), EXCLUDE_PREFIX) == 0)
+        {
+            continue;
+        }
+
+        // Process each classifier XML file in the configuration.
+        boost::filesystem::path file(fname + ".xml");
+        std::string dir_name;
+        std::stringstream dirs(config["DIRS"]);
+        while(dirs >> dir_name){
+
+            // Assemble the filename.
+            boost::filesystem::path dir (dir_name);
+            boost::filesystem::path full = dir / file;
+            if(!boost::filesystem::exists(full))
+            {
+                continue;
+            }
+
+            // Assemble the color object.
+            // The color may be followed by the classifier's own
+            // detection parameters (overriding the settings of the
+            // same names, e.g. "min_size_ratio 0.2"), and overload
+            // policy (overriding CLASSIFIER_POLICY.)
+            int rr, gg, bb;
+            std::stringstream values(config[fname]);
+            values >> rr >> gg >> bb;
+            cv::Scalar color(rr, gg, bb);
+            float own_resolution = resolution;
+            float scale_factor = atof(config["SCALE_FACTOR"].c_str());
+            int min_neighbors = atoi(config["MIN_NEIGHBORS"].c_str());
+            float min_size_ratio = atof(config["MIN_SIZE_RATIO"].c_str());
+            float max_size_ratio = atof(config["MAX_SIZE_RATIO"].c_str());
+            while (true)
+            {
+                auto position = values.tellg();
+                std::string key, value;
+                if (!(values >> key) || (key != "resolution" && key != "scale_factor"
+                    && key != "min_neighbors" && key != "min_size_ratio"
+                    && key != "max_size_ratio"))
+                {
+                    values.clear();
+                    values.seekg(position);
+                    break;
+                }
+                values >> value;
+                std::istringstream number (value);
+                float parsed = 0;
+                bool valid = key == "resolution"
+                    ? parseResolution(value, own_resolution)
+                    : number >> parsed && number.eof() && parsed >= 0;
+                if (key == "scale_factor")
+                {
+                    valid = valid && parsed > 1;
+                    if (valid) scale_factor = parsed;
+                }
+                if (key == "min_neighbors")
+                {
+                    valid = valid && parsed == (int)parsed;
+                    if (valid) min_neighbors = parsed;
+                }
+                if (key == "min_size_ratio" || key == "max_size_ratio")
+                {
+                    valid = valid && parsed <= 1;
+                    if (valid) (key == "min_size_ratio" ? min_size_ratio : max_size_ratio) = parsed;
+                }
+                if (!valid)
+                {
+                    std::cout << "Warning: Invalid " << key << " \"" << value
+                              << "\" of " << fname << std::endl;
+                }
+            }
+            EdgePolicy policy = settings.classifier_policy;
+            std::string spec;
+            if(std::getline(values, spec) && !parseEdgePolicy(spec, policy)
+               && spec.find_first_not_of(" \t") != std::string::npos)
+            {
+                std::cout << "Warning: Invalid policy \"" << spec
+                          << "\" of " << fname << std::endl;
+            }
+
+            entries.push_back({
+                full.string(),
+                {
+                    color,
+                    scale_factor,
+                    min_neighbors,
+                    min_size_ratio,
+                    max_size_ratio,
+                    native,
+                    own_resolution,
+                    tiles,
+                    exclusion,
+                },
+                policy});
+        }
+    }
+    return entries;
+}
+
+} // namespace sherlock.
@@ -3,26 +3,98 @@
 */
 
 // Include standard headers.
+#include <csignal>
+#include <iostream>
+#include <limits>
 #include <string>
 #include <sstream>
+#include <vector>
 
 // Include application headers.
 #include "sherlock.hpp"
 
+namespace {
+
+// The detector running (for stopping on signals.)
+sherlock::Detector* detector = NULL;
+
+// Stop detection on interrupt or termination.
+void onSignal(int)
+{
+    if (detector)
+    {
+        detector->stop();
+    }
+}
+
+}  // namespace.
+
 int main(int argc, char** argv)
 {
+    // Separate the options from the positional arguments.
+    std::string RECORD_FNAME, REPLAY_FNAME, LOG_FNAME, CONTROL_PATH, EVENTS_ADDRESS, TRACE_FNAME;
+    auto EVENTS_FORMAT = sherlock::EventStream::JSON;
+    bool REALTIME = true;
+    int DECODERS = 2;
+    bool WINDOW = true;
+    bool PERF = false;
+    std::vector <std::string> args;
+    for (int ii = 1; ii < argc; ++ii)
+    {
+        std::string arg (argv[ii]);
+        if (arg == "--record" && ii + 1 < argc) RECORD_FNAME = argv[++ii];
+        else if (arg == "--replay" && ii + 1 < argc) REPLAY_FNAME = argv[++ii];
+        else if (arg == "--log" && ii + 1 < argc) LOG_FNAME = argv[++ii];
+        else if (arg == "--trace" && ii + 1 < argc) TRACE_FNAME = argv[++ii];
+        else if (arg == "--control" && ii + 1 < argc) CONTROL_PATH = argv[++ii];
+        else if (arg == "--events" && ii + 1 < argc) EVENTS_ADDRESS = argv[++ii];
+        else if (arg == "--binary-events") EVENTS_FORMAT = sherlock::EventStream::BINARY;
+        else if (arg == "--fast") REALTIME = false;
+        else if (arg == "--decoders" && ii + 1 < argc) std::istringstream(argv[++ii]) >> DECODERS;
+        else if (arg == "--no-window") WINDOW = false;
+        else if (arg == "--perf") PERF = true;
+        else args.push_back(arg);
+    }
+    if (args.size() < 4)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " [--record FILE | --replay FILE [--fast] [--decoders N]] [--log FILE] [--trace FILE]"
+                  << " [--control SOCKET] [--no-window] [--perf]"
+                  << " [--events unix:PATH|tcp:[HOST:]PORT [--binary-events]]"
+                  << " DEVICE WIDTH HEIGHT DURATION [MAX_FPS] [CONFIG]" << std::endl;
+        std::cout << "A DURATION of 0 runs until interrupted." << std::endl;
+        return 1;
+    }
+
     // Parse command-line arguments.
     int DEVICE, WIDTH, HEIGHT, DURATION;
-    float MAX_FPS;
+    float MAX_FPS = std::numeric_limits<float>::max();
     std::string CONFIG_FNAME ("conf/classifiers.conf");
-    std::istringstream(std::string(argv[1])) >> DEVICE;
-    std::istringstream(std::string(argv[2])) >> WIDTH;
-    std::istringstream(std::string(argv[3])) >> HEIGHT;
-    std::istringstream(std::string(argv[4])) >> DURATION;
-    if (argc > 5) std::istringstream(std::string(argv[5])) >> MAX_FPS;
-    if (argc > 6) std::istringstream(std::string(argv[6])) >> CONFIG_FNAME;
-
-    // Run the detector.
-    sherlock::Detector det (DEVICE, WIDTH, HEIGHT, DURATION, MAX_FPS, CONFIG_FNAME);
-    det.run();
+    std::istringstream(args[0]) >> DEVICE;
+    std::istringstream(args[1]) >> WIDTH;
+    std::istringstream(args[2]) >> HEIGHT;
+    std::istringstream(args[3]) >> DURATION;
+    if (args.size() > 4) std::istringstream(args[4]) >> MAX_FPS;
+    if (args.size() > 5) std::istringstream(args[5]) >> CONFIG_FNAME;
+
+    // Run the detector, for the duration (if positive),
+    // or until interrupted (or terminated.)
+    {
+        sherlock::Detector det (DEVICE, WIDTH, HEIGHT, DURATION, MAX_FPS, CONFIG_FNAME);
+        if (!RECORD_FNAME.empty()) det.setRecording(RECORD_FNAME);
+        if (!REPLAY_FNAME.empty()) det.setReplay(REPLAY_FNAME, REALTIME, DECODERS);
+        if (!LOG_FNAME.empty()) det.setDetectionLog(LOG_FNAME);
+        if (!TRACE_FNAME.empty()) det.setTrace(TRACE_FNAME);
+        if (!CONTROL_PATH.empty()) det.setControl(CONTROL_PATH);
+        if (!EVENTS_ADDRESS.empty()) det.setEventStream(EVENTS_ADDRESS, EVENTS_FORMAT);
+        det.setWindow(WINDOW);
+        det.setPerfCounters(PERF);
+        detector = &det;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        det.run();
+    }
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    detector = NULL;
 }
@@ -0,0 +1,63 @@
+// Print detection events streamed by detect (see --events).
+
+// Include standard headers.
+#include <iostream>
+#include <string>
+
+// Include system headers.
+#include <unistd.h>
+
+// Include application headers.
+#include "sherlock.hpp"
+
+int main(int argc, char** argv)
+{
+    // Parse command-line arguments.
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " unix:PATH|tcp:[HOST:]PORT [--binary]" << std::endl;
+        return 1;
+    }
+    std::string ADDRESS (argv[1]);
+    bool BINARY = argc > 2 && std::string(argv[2]) == "--binary";
+
+    int fd = sherlock::EventStream::connect(ADDRESS);
+    if (fd < 0)
+    {
+        std::cout << "Failed to connect to " << ADDRESS << std::endl;
+        return 1;
+    }
+
+    // Print events as they arrive (JSON lines as they are,
+    // binary records decoded into the same fields.)
+    std::string buffer;
+    char chunk[4096];
+    ssize_t length;
+    long count = 0;
+    while ((length = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        if (!BINARY)
+        {
+            std::cout.write(chunk, length);
+            std::cout.flush();
+            continue;
+        }
+        buffer.append(chunk, length);
+        sherlock::EventStream::Event event;
+        size_t used;
+        while ((used = sherlock::EventStream::decode(buffer.data(), buffer.size(), event)) > 0)
+        {
+            std::cout << event.frame << " " << event.time << " " << event.classifier << " "
+                      << event.rect.x << " " << event.rect.y << " "
+                      << event.rect.width << " " << event.rect.height << std::endl;
+            buffer.erase(0, used);
+            ++count;
+        }
+    }
+    close(fd);
+    if (BINARY)
+    {
+        std::cout << count << " events" << std::endl;
+    }
+}
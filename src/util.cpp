@@ -3,16 +3,20 @@
 */
 #include <list>
 #include <string>
+#include <vector>
 #include <boost/date_time.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "sherlock.hpp"
+
 namespace sherlock {
 
 double getAlpha(
     boost::posix_time::ptime& tstamp_prev,
-    double max_life)
+    double max_life,
+    Clock& clock)
 {
-    auto now = boost::posix_time::microsec_clock::universal_time();
+    auto now = clock.now();
     double alpha = 1.0;  // Default is 100% opacity.
     if (!tstamp_prev.is_not_a_date_time()) 
     {
@@ -27,6 +31,21 @@ double getAlpha(
 }
 
 
+void scaleRects(
+    std::vector<cv::Rect>& rects,
+    const double& factor)
+{
+    for (auto& rect : rects)
+    {
+        rect = cv::Rect(
+            cvRound(rect.x * factor),
+            cvRound(rect.y * factor),
+            cvRound(rect.width * factor),
+            cvRound(rect.height * factor));
+    }
+}
+
+
 void writeOSD(
     cv::Mat& image, 
     const std::list<std::string>& lines, 